@@ -1,6 +1,9 @@
 
 #pragma once
 
+#include <math.h>
+#include <stdint.h>
+
 inline static bool fcomp(const float lhs, const float rhs, const int precision = 2) {
     auto digits = precision * 10;
     auto lhs_int = static_cast<int32_t>(roundf(lhs * digits));
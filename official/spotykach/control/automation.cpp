@@ -0,0 +1,129 @@
+#include "automation.h"
+
+using namespace blptls;
+using namespace spotykach;
+
+void Automation::toggle_recording() {
+    switch (_state) {
+        case State::Recording: start_playing(); break;
+        default: start_recording(); break;
+    }
+}
+
+void Automation::clear() {
+    _state = State::Idle;
+    _is_active.fill(false);
+}
+
+/*
+Lanes start on the first process() call after the recording is armed,
+since that's where the live value of the knob is known. They hold it back
+to the pattern start before, so the loop starts with the pattern.
+*/
+void Automation::start_recording() {
+    _state = State::Recording;
+    _length = 0;
+    _is_active.fill(false);
+    _is_started.fill(false);
+}
+
+//The loop is rounded to whole patterns and keeps the phase it was recorded with.
+void Automation::start_playing() {
+    for (auto& l: _lanes) l.end();
+    auto length = (_length + _pattern_ticks / 2) / _pattern_ticks * _pattern_ticks;
+    length = length > 0 ? length : _pattern_ticks;
+    length = length < kMaxLength ? length : kMaxLength;
+    _loop_position = _length % length;
+    _length = length;
+    for (auto& l: _lanes) {
+        l.rewind();
+        l.advance(_loop_position);
+    }
+    auto any_active = false;
+    for (size_t i = 0; i < kLanesCount; i++) {
+        _origin[i] = _last[i];
+        any_active |= _is_active[i];
+    }
+    _state = any_active ? State::Playing : State::Idle;
+}
+
+void Automation::advance(uint32_t position, uint32_t pattern_position, uint32_t pattern_ticks) {
+    _elapsed = _is_first_pass ? 0 : position - _position;
+    _position = position;
+    _is_first_pass = false;
+    auto is_pattern_started = pattern_position < _pattern_position;
+    _pattern_position = pattern_position;
+    _pattern_ticks = pattern_ticks;
+
+    switch (_state) {
+        case State::Recording: {
+            if (!_is_started[0]) {
+                _elapsed = 0;
+                _lead = pattern_position < kMaxLength ? pattern_position : 0;
+                _length = _lead;
+            }
+            if (_length + _elapsed >= kMaxLength) {
+                _elapsed = kMaxLength - _length;
+                _length = kMaxLength;
+                //The last ticks are recorded by process() in this pass.
+                break;
+            }
+            _length += _elapsed;
+            break;
+        }
+        case State::Playing: {
+            if (_elapsed == 0) break;
+            auto loop_position = _loop_position + _elapsed;
+            //A pattern start the loop is out of step with, after a trigger reset
+            //or a pattern change, restarts it.
+            if (is_pattern_started && loop_position % pattern_ticks != pattern_position) loop_position = pattern_position;
+            if (loop_position >= _loop_position && loop_position < _length) {
+                for (size_t i = 0; i < kLanesCount; i++) if (_is_active[i]) _lanes[i].advance(loop_position - _loop_position);
+            }
+            else {
+                loop_position %= _length;
+                for (size_t i = 0; i < kLanesCount; i++) {
+                    if (!_is_active[i]) continue;
+                    _lanes[i].rewind();
+                    _lanes[i].advance(loop_position);
+                }
+            }
+            _loop_position = loop_position;
+            break;
+        }
+        default: {}
+    }
+}
+
+float Automation::process(size_t lane, float live) {
+    auto q = quantize(live);
+    switch (_state) {
+        case State::Recording: {
+            auto& l = _lanes[lane];
+            if (!_is_started[lane]) {
+                l.begin(q);
+                if (_lead > 0) l.record(q, _lead);
+                _origin[lane] = q;
+                _is_started[lane] = true;
+            }
+            else {
+                if (!moved(_last[lane], q, kDeadband)) q = _last[lane];
+                l.record(q, _elapsed);
+                _is_active[lane] |= moved(_origin[lane], q);
+            }
+            _last[lane] = q;
+            if (lane == kLanesCount - 1 && _length == kMaxLength) start_playing();
+            return live;
+        }
+        case State::Playing: {
+            if (!_is_active[lane]) return live;
+            //_origin holds the knob position the recording was stopped at.
+            if (moved(_origin[lane], q)) {
+                _is_active[lane] = false;
+                return live;
+            }
+            return static_cast<float>(_lanes[lane].value()) / Lane::kMaxValue;
+        }
+        default: return live;
+    }
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include "automation.lane.h"
+#include "../core/globals.h"
+
+namespace blptls {
+namespace spotykach {
+
+/*
+Knob motion recorder. All knobs are recorded at once,
+the lanes of the knobs that moved loop in sync with the pattern
+of engine A, the others keep following their knobs.
+Moving a knob during playback hands it back to the hand.
+Lanes take a value every kTicksPerStep ticks and have room for
+a knob moving all through kMaxLength.
+*/
+class Automation {
+public:
+    static constexpr size_t kLanesCount = 12;
+    static constexpr uint32_t kMaxLength = 8 * kBeatsPerMeasure * kPPQN;
+    static constexpr uint32_t kTicksPerStep = 4;
+    static constexpr size_t kLaneCapacity = kMaxLength / kTicksPerStep;
+
+    enum class State {
+        Idle,
+        Recording,
+        Playing
+    };
+
+    Automation() = default;
+    ~Automation() = default;
+
+    void toggle_recording();
+    void clear();
+
+    /*
+    Called once per controller pass, before the knob values are passed
+    through process(), with the clock position and where the pattern
+    the lanes are anchored to is, see ITrigger::pattern_position().
+    */
+    void advance(uint32_t position, uint32_t pattern_position, uint32_t pattern_ticks);
+
+    //Returns the value the knob target should be set to.
+    float process(size_t lane, float live);
+
+    State state() const { return _state; }
+
+private:
+    static constexpr uint16_t kTouchThreshold = 24;
+    //Changes this small are taken for ADC noise and not recorded.
+    static constexpr uint16_t kDeadband = 2;
+
+    static uint16_t quantize(float value) {
+        auto q = static_cast<int32_t>(value * Lane::kMaxValue + 0.5f);
+        return static_cast<uint16_t>(q < 0 ? 0 : (q > Lane::kMaxValue ? Lane::kMaxValue : q));
+    }
+
+    static bool moved(uint16_t from, uint16_t to, uint16_t threshold = kTouchThreshold) {
+        return (from > to ? from - to : to - from) > threshold;
+    }
+
+    void start_recording();
+    void start_playing();
+
+    using Lane = AutomationLane<kLaneCapacity, kTicksPerStep>;
+    std::array<Lane, kLanesCount> _lanes;
+    std::array<uint16_t, kLanesCount> _origin;
+    std::array<uint16_t, kLanesCount> _last;
+    std::array<bool, kLanesCount> _is_active;
+    std::array<bool, kLanesCount> _is_started;
+
+    State _state = State::Idle;
+    bool _is_first_pass = true;
+    uint32_t _position = 0;
+    uint32_t _pattern_position = 0;
+    uint32_t _pattern_ticks = kPPQN;
+    uint32_t _lead = 0;
+    uint32_t _elapsed = 0;
+    uint32_t _length = 0;
+    uint32_t _loop_position = 0;
+};
+
+}
+}
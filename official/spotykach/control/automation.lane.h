@@ -0,0 +1,160 @@
+#pragma once
+
+#include <array>
+#include <stdint.h>
+#include <stddef.h>
+
+namespace blptls {
+namespace spotykach {
+
+/*
+Knob motion of one knob, one 10 bit value per step of kTicksPerStep clock ticks,
+encoded into a fixed byte array:
+0nnnnnnn - the value holds for n + 1 steps,
+1ddddddd - the value changes by d (signed) for one step,
+11000000 hi lo - the value jumps to (hi << 8 | lo) for one step.
+A still knob costs a byte per 128 steps, a moving one a byte per step.
+Playback glides from a step's value to the next one's over its ticks.
+Once the array is full the last value holds till the end of the loop.
+*/
+template <size_t kCapacity, uint32_t kTicksPerStep = 1>
+class AutomationLane {
+public:
+    static constexpr uint16_t kMaxValue = 1023;
+
+    void begin(uint16_t value) {
+        _length = 0;
+        _is_full = false;
+        _start = value;
+        _recorded = value;
+        _run = 0;
+        _recorded_phase = 0;
+        rewind();
+    }
+
+    //Records the value for the given number of ticks, the knob is considered
+    //still for all of them but the last. The value at a step's end is kept.
+    void record(uint16_t value, uint32_t ticks) {
+        if (ticks == 0 || _is_full) return;
+        _recorded_phase += ticks;
+        auto steps = _recorded_phase / kTicksPerStep;
+        _recorded_phase %= kTicksPerStep;
+        if (steps == 0) return;
+        hold(steps - 1);
+        auto delta = static_cast<int32_t>(value) - static_cast<int32_t>(_recorded);
+        if (delta == 0) {
+            hold(1);
+            return;
+        }
+        flush();
+        if (delta >= -kMaxDelta && delta <= kMaxDelta) {
+            push(kChange | (delta & kDeltaMask));
+        }
+        else if (_length + 3 <= kCapacity) {
+            push(kJump);
+            push(value >> 8);
+            push(value & 0xff);
+        }
+        else {
+            _is_full = true;
+        }
+        if (!_is_full) _recorded = value;
+    }
+
+    void end() {
+        flush();
+    }
+
+    void rewind() {
+        _cursor = 0;
+        _held = 0;
+        _phase = 0;
+        _value = _start;
+        _next = _start;
+        step();
+    }
+
+    uint16_t advance(uint32_t ticks) {
+        _phase += ticks;
+        auto steps = _phase / kTicksPerStep;
+        _phase %= kTicksPerStep;
+        for (; steps > 0; steps--) {
+            _value = _next;
+            step();
+        }
+        return value();
+    }
+
+    uint16_t value() const {
+        auto delta = static_cast<int32_t>(_next) - static_cast<int32_t>(_value);
+        return static_cast<uint16_t>(_value + delta * static_cast<int32_t>(_phase) / static_cast<int32_t>(kTicksPerStep));
+    }
+
+    size_t size() const { return _length; }
+    bool is_full() const { return _is_full; }
+
+private:
+    static constexpr uint8_t kChange = 0x80;
+    static constexpr uint8_t kJump = 0xc0;
+    static constexpr uint8_t kDeltaMask = 0x7f;
+    static constexpr int32_t kMaxDelta = 63;
+    static constexpr uint32_t kMaxRun = 128;
+
+    void hold(uint32_t ticks) {
+        _run += ticks;
+        while (_run >= kMaxRun) {
+            push(kMaxRun - 1);
+            _run -= kMaxRun;
+        }
+    }
+
+    void flush() {
+        if (_run > 0) push(_run - 1);
+        _run = 0;
+    }
+
+    void push(uint8_t byte) {
+        if (_length == kCapacity) {
+            _is_full = true;
+            return;
+        }
+        _data[_length++] = byte;
+    }
+
+    //Decodes the value of the step after the current one into _next.
+    void step() {
+        if (_held > 0) {
+            _held--;
+            return;
+        }
+        if (_cursor >= _length) return;
+        uint8_t byte = _data[_cursor++];
+        if (!(byte & kChange)) {
+            _held = byte;
+        }
+        else if (byte == kJump) {
+            _next = (_data[_cursor] << 8) | _data[_cursor + 1];
+            _cursor += 2;
+        }
+        else {
+            _next += static_cast<int8_t>(byte << 1) >> 1;
+        }
+    }
+
+    std::array<uint8_t, kCapacity> _data;
+    size_t _length = 0;
+    bool _is_full = false;
+    uint16_t _start = 0;
+    uint16_t _recorded = 0;
+    uint32_t _run = 0;
+    uint32_t _recorded_phase = 0;
+
+    size_t _cursor = 0;
+    uint32_t _held = 0;
+    uint32_t _phase = 0;
+    uint16_t _value = 0;
+    uint16_t _next = 0;
+};
+
+}
+}
@@ -1,6 +1,7 @@
 #include "clock.h"
 #include "../common/fcomp.h"
 #include "../core/globals.h"
+#include <algorithm>
 
 using namespace blptls;
 using namespace spotykach;
@@ -49,9 +50,12 @@ void Clock::emit_ticks() {
     //and adjust tempo.
     if (_resync) {
         _fticks = 0;
-        nticks = kTicksPerClock - (_ticks - _ticks_at_last_clock);
+        nticks = _ticks_per_clock - (_ticks - _ticks_at_last_clock);
         _ticks_at_last_clock = _ticks + nticks;
-        _tempo_mks -= ((int32_t)kTicksPerClock - (int32_t)_tempo_ticks) * (int32_t)_tempo_mks / (int32_t)kPPQN;
+        //Timestamped clock (MIDI) sets the tempo itself.
+        if (!_timestamped) {
+            _tempo_mks -= ((int32_t)_ticks_per_clock - (int32_t)_tempo_ticks) * (int32_t)_tempo_mks / (int32_t)kPPQN;
+        }
         _tempo_ticks = 0;
         _resync = false;
     }
@@ -64,8 +68,8 @@ void Clock::emit_ticks() {
             //If there are more internal ticks per the external tick than 
             //expected, we set _hold to true effectively stopping advancing timeline
             //until next external tick
-            if (_ticks - _ticks_at_last_clock + nticks >= kTicksPerClock) {
-                nticks = kTicksPerClock - 1 - (_ticks - _ticks_at_last_clock);
+            if (_ticks - _ticks_at_last_clock + nticks >= _ticks_per_clock) {
+                nticks = _ticks_per_clock - 1 - (_ticks - _ticks_at_last_clock);
                 _hold = true;
             }
         }
@@ -73,6 +77,7 @@ void Clock::emit_ticks() {
 
     //Accumulate ticks
     _ticks += nticks;
+    _position += nticks;
 
     //Advance timeline
     for (uint32_t i = 0; i < nticks; i++) _clockable->tick();
@@ -118,12 +123,24 @@ void Clock::set_tempo(float norm_value) {
     }
 }
 
+/*
+Tempo found in a recording, see TempoEstimator.
+Replaces the manual tempo only, the tempo knob takes over once it's turned.
+*/
+void Clock::propose_tempo(float tempo) {
+    if (external_clock()) return;
+    _manual_tempo = std::min(std::max(tempo, kTempoMin), kTempoMax);
+    _tempo_mks = tempo_mks(_manual_tempo);
+}
+
 /*
 Read external clock pin
 */
 void Clock::pull(daisy::DaisySeed& hw) {
     auto new_state = g.Read();
     if (new_state && !_last_state) {
+        _ticks_per_clock = kPPQN / kPulsePPQN;
+        _timestamped = false;
         external_clock_tick();
     }
     _last_state = new_state;
@@ -150,6 +167,52 @@ void Clock::external_clock_tick() {
     }
 }
 
+/*
+MIDI clock, 24 PPQN, each clock is followed by 4 internal ticks.
+Tempo is taken from the smoothed interval between clock timestamps,
+so jitter of a single clock doesn't bend the tempo.
+An interval too far off the average (e.g. after a pause) restarts the average.
+*/
+void Clock::midi_clock(uint32_t timestamp) {
+    if (!external_clock()) return;
+    if (_last_midi_clock != 0) {
+        float interval = timestamp - _last_midi_clock;
+        if (_midi_interval > 0 && interval > 0.5f * _midi_interval && interval < 2.f * _midi_interval) {
+            _midi_interval += kMidiSmoothing * (interval - _midi_interval);
+        }
+        else {
+            _midi_interval = interval;
+        }
+        _tempo_mks = static_cast<uint32_t>(_midi_interval * kMidiPPQN);
+    }
+    _last_midi_clock = timestamp;
+    _ticks_per_clock = kPPQN / kMidiPPQN;
+    _timestamped = true;
+    external_clock_tick();
+}
+
+// Playback starts on the next clock.
+void Clock::midi_start() {
+    if (!external_clock()) return;
+    _is_running = false;
+    _is_about_to_run = true;
+    _last_midi_clock = 0;
+    reset();
+}
+
+void Clock::midi_continue() {
+    if (!external_clock() || _is_running) return;
+    _is_about_to_run = true;
+    _last_midi_clock = 0;
+}
+
+void Clock::midi_stop() {
+    if (!external_clock()) return;
+    _is_running = false;
+    _is_about_to_run = false;
+    reset();
+}
+
 void Clock::reset() {
     _fticks = 0;
     _ticks = 0;
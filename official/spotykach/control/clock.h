@@ -19,10 +19,19 @@ public:
     
     float tempo() { return 60000000.f / _tempo_mks; }
     void set_tempo(float normValue);
+    void propose_tempo(float tempo);
 
     void toggle_is_running();
     bool is_running() { return _is_running; };
 
+    //Ticks emitted since power on, never reset.
+    uint32_t position() const { return _position; }
+
+    void midi_clock(uint32_t timestamp);
+    void midi_start();
+    void midi_continue();
+    void midi_stop();
+
 private:
     bool external_clock() { return _manual_tempo < kTempoMin; }
     void external_clock_tick();
@@ -38,13 +47,17 @@ private:
     bool _is_running = false;
     bool _is_about_to_run = false;
 
-    const uint32_t kInterval = 1e6 * kBufferSize / kSampleRate;
-    const uint32_t kTRtime = kPPQN * kInterval;
-    const uint32_t kTicksPerClock = kPPQN / 4;
+    static constexpr uint32_t kInterval = Policy::block_mks;
+    static constexpr uint32_t kTRtime = kPPQN * kInterval;
+    static constexpr uint32_t kPulsePPQN = 4;
+    static constexpr uint32_t kMidiPPQN = 24;
+    static constexpr float kMidiSmoothing = 0.1f;
+    uint32_t _ticks_per_clock = kPPQN / kPulsePPQN;
     uint32_t _ticks = 0;
     uint32_t _fticks = 0;
     uint32_t _ticks_at_last_clock = 0;
     uint32_t _tempo_ticks = 0;
+    volatile uint32_t _position = 0;
     bool _hold = false;
     bool _resync = false;
 
@@ -53,6 +66,10 @@ private:
     uint32_t _tempo_mks = 500000;
 
     int _last_state = 1;
+
+    bool _timestamped = false;
+    uint32_t _last_midi_clock = 0;
+    float _midi_interval = 0;
 };
 
 }
@@ -60,6 +60,36 @@ void Controller::init_sensor(Core& core, Clock &clock) {
     _sensor.set_on_touch([&t_a, this] { this->store_pattern_index_a(t_a.next_pattern(), t_a.grid()); }, Target::PatternPlusA);
     _sensor.set_on_touch([&t_b, this] { this->store_pattern_index_b(t_b.prev_pattern(), t_b.grid()); }, Target::PatternMinusB);
     _sensor.set_on_touch([&t_b, this] { this->store_pattern_index_b(t_b.next_pattern(), t_b.grid()); }, Target::PatternPlusB);
+    //Pattern pads step on the release, so a combo they're part of can cancel them.
+    for (auto t: { Target::PatternMinusA, Target::PatternPlusA, Target::PatternMinusB, Target::PatternPlusB }) {
+        _sensor.set_mode(DescreteSensorPad::Mode::Deferred, t);
+    }
+    _sensor.set_on_touch([this] { this->_automation.toggle_recording(); }, Target::AutomationRecord);
+    _sensor.set_on_touch([this] { this->_automation.clear(); }, Target::AutomationClear);
+    _sensor.set_exclusive(Target::AutomationRecord);
+    _sensor.set_exclusive(Target::AutomationClear);
+
+    auto& e_a = core.engineAt(0);
+    auto& e_b = core.engineAt(1);
+    //Pattern minus with reverse one shot undoes the last take, pattern plus with forward one shot redoes it.
+    _sensor.set_on_touch([&e_a] { e_a.undo(); }, Target::UndoA);
+    _sensor.set_on_touch([&e_a] { e_a.redo(); }, Target::RedoA);
+    _sensor.set_on_touch([&e_b] { e_b.undo(); }, Target::UndoB);
+    _sensor.set_on_touch([&e_b] { e_b.redo(); }, Target::RedoB);
+    for (auto t: { Target::UndoA, Target::RedoA, Target::UndoB, Target::RedoB }) _sensor.set_exclusive(t);
+    //Pattern minus with forward one shot switches to the next recording.
+    _sensor.set_on_touch([&e_a] { e_a.select_next_source(); }, Target::NextSourceA);
+    _sensor.set_on_touch([&e_b] { e_b.select_next_source(); }, Target::NextSourceB);
+    _sensor.set_exclusive(Target::NextSourceA);
+    _sensor.set_exclusive(Target::NextSourceB);
+    //Pattern plus with reverse one shot toggles spectral freeze.
+    _sensor.set_mode(DescreteSensorPad::Mode::Toggle, Target::SpectralA);
+    _sensor.set_mode(DescreteSensorPad::Mode::Toggle, Target::SpectralB);
+    _sensor.set_exclusive(Target::SpectralA);
+    _sensor.set_exclusive(Target::SpectralB);
+    //Both pattern plus pads toggle the reverb.
+    _sensor.set_mode(DescreteSensorPad::Mode::Toggle, Target::Reverb);
+    _sensor.set_exclusive(Target::Reverb);
 }
 
 void Controller::store_pattern_index_a(int index, Grid g) {
@@ -99,9 +129,11 @@ using KT = Knob::Target;
 void Controller::set_knob_parameters(Core& s, Clock& clck) {
     auto& a = s.engineAt(0);
     auto& b = s.engineAt(1);
+    auto& t_a = a.trig();
+    _automation.advance(clck.position(), t_a.pattern_position(), t_a.pattern_ticks());
     for (size_t i = 0; i < _knobs.size(); i++) {
         auto t = _knobs[i].target();
-        auto v = _knobs[i].value();
+        auto v = _automation.process(i, _knobs[i].value());
         switch (t) {
             case KT::SlicePositionA:    a.set_slice_position(v);    break;
             case KT::SliceLengthA:      a.set_slice_length(v);      break;
@@ -168,6 +200,11 @@ void Controller::read_sensor(Core& core, Leds& leds, Clock& clock) {
     e_a.set_frozen(!_rec_a);
     e_b.set_frozen(!_rec_b);
 
+    e_a.set_spectral(_sensor.is_on(Target::SpectralA));
+    e_b.set_spectral(_sensor.is_on(Target::SpectralB));
+
+    core.set_reverb_amount(_sensor.is_on(Target::Reverb) ? kReverbAmount : 0);
+
     _holding_fwd_a = _sensor.is_on(Target::OneShotFwdA);
     _holding_fwd_b = _sensor.is_on(Target::OneShotFwdB);
     _holding_rev_a = !_rec_a && _sensor.is_on(Target::OneShotRevA);
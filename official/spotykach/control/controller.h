@@ -10,6 +10,7 @@
 #include "leds.h"
 #include "persistense.h"
 #include "clock.h"
+#include "automation.h"
 
 namespace blptls {
 namespace spotykach {
@@ -43,11 +44,15 @@ private:
     void store_pattern_index_a(int index, Grid g);
     void store_pattern_index_b(int index, Grid g);
 
+    //Reverb dry/wet when it's toggled on.
+    static constexpr float kReverbAmount = 0.35f;
+
     DescreteSensor _sensor;
     std::array<Knob, 12> _knobs;
     std::array<ChannelToggles, 2> _channel_toggles;
     GlobalToggles _global_toggles;
     Persistence _store;
+    Automation _automation;
 
     bool _holding_fwd_a = false;
     bool _holding_fwd_b = false;
@@ -53,13 +53,24 @@ public:
         OneShotRevB,
         RecordB,
         PatternMinusB,
-        PatternPlusB
+        PatternPlusB,
+        AutomationRecord,
+        AutomationClear,
+        UndoA,
+        RedoA,
+        UndoB,
+        RedoB,
+        NextSourceA,
+        NextSourceB,
+        SpectralA,
+        SpectralB,
+        Reverb
     };
     //
     //TARGET COUNT ######################################################
     //
     //Should be the same as the number of entries in Target enum
-    static const int targets_count = 11;
+    static const int targets_count = 22;
     //
     //###################################################################
 
@@ -85,7 +96,18 @@ public:
           _pin(6),                      //OneShotRevB,
           _together(_pin(6), _pin(7)),  //RecordB
           _pin(8),                      //PatternMinusB,
-          _pin(9)                       //PatternPlusB
+          _pin(9),                      //PatternPlusB
+          _together(_pin(1), _pin(2)),  //AutomationRecord
+          _together(_pin(8), _pin(9)),  //AutomationClear
+          _together(_pin(2), _pin(3)),  //UndoA
+          _together(_pin(1), _pin(4)),  //RedoA
+          _together(_pin(8), _pin(6)),  //UndoB
+          _together(_pin(9), _pin(7)),  //RedoB
+          _together(_pin(2), _pin(4)),  //NextSourceA
+          _together(_pin(8), _pin(7)),  //NextSourceB
+          _together(_pin(1), _pin(3)),  //SpectralA
+          _together(_pin(9), _pin(6)),  //SpectralB
+          _together(_pin(1), _pin(9))   //Reverb
         };
         //
         //#################################################################
@@ -98,7 +120,11 @@ public:
 
         _state = state;
 
-        for (auto& p: _pads) p.process(state);
+        uint16_t claimed = 0;
+        for (auto& p: _pads) {
+            if (p.exclusive && p.is_touched(state)) claimed |= p.mask();
+        }
+        for (auto& p: _pads) p.process(state, claimed);
     }
     
     void set_on_touch(std::function<void()> on_touch, Target target) {
@@ -113,6 +139,16 @@ public:
         pad(target).mode = mode;
     }
 
+    /*
+    While all pads of an exclusive target are held, targets on a part of
+    them are cancelled. Pads are never touched at exactly the same time,
+    so targets sharing pads with one should be Immediate and read with is_on(),
+    or Deferred.
+    */
+    void set_exclusive(Target target) {
+        pad(target).exclusive = true;
+    }
+
     bool is_on(Target target) {
         return pad(target).is_on();
     }
@@ -7,7 +7,8 @@ class DescreteSensorPad {
 public:
     enum class Mode {
         Toggle, //on on the first touch, off on the second
-        Immediate //on on the touch, off on the release
+        Immediate, //on on the touch, off on the release
+        Deferred //like Immediate, but on_touch is called on the release
     };
 
     DescreteSensorPad() = default;
@@ -18,28 +19,50 @@ public:
 
     Mode mode = Mode::Immediate;
 
+    //Holding an exclusive pad cancels the pads on a part of its pins.
+    bool exclusive = false;
+
     void initialize(uint16_t mask) {
         _mask = mask;
     }
 
-    void process(uint16_t state) {
-        auto new_is_touched = (state & _mask) == _mask;
+    uint16_t mask() const { return _mask; }
+
+    bool is_touched(uint16_t state) const {
+        return (state & _mask) == _mask;
+    }
+
+    /*
+    claimed - pins of the exclusive pads being held. A touch on them is
+    cancelled till the pad is released: it calls nothing and a toggle
+    flips back.
+    */
+    void process(uint16_t state, uint16_t claimed) {
+        auto new_is_touched = is_touched(state);
 
         // if it *wasn't* touched and now *is*
         if (new_is_touched && !_is_touched) {
+            _is_cancelled = false;
             //call back
-            if (on_touch) on_touch();
+            if (on_touch && mode != Mode::Deferred) on_touch();
             
             //set state
             _is_on = (mode == Mode::Toggle) ? !_is_on : true;
         }
+        if (new_is_touched && !exclusive && (_mask & claimed) && !_is_cancelled) {
+            _is_cancelled = true;
+            _is_on = (mode == Mode::Toggle) ? !_is_on : false;
+        }
         // if it *was* touched and now *isnt*
         if (!new_is_touched && _is_touched) {
             //call back
-            if (on_release) on_release();
+            if (!_is_cancelled) {
+                if (on_touch && mode == Mode::Deferred) on_touch();
+                if (on_release) on_release();
+            }
 
             //set state
-            if (mode == Mode::Immediate) _is_on = false;
+            if (mode != Mode::Toggle) _is_on = false;
         }
 
         _is_touched = new_is_touched;
@@ -52,5 +75,6 @@ public:
 private:
     uint16_t _mask;
     bool _is_touched = false;
+    bool _is_cancelled = false;
     bool _is_on = false; //toggle only
 };
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include "hid/led.h"
+#include "sys/system.h"
 #include "../core/globals.h"
 
 namespace blptls {
@@ -18,17 +19,18 @@ public:
     _led_r.Init(daisy::seed::D5, false);
     }
 
+    //Duration is in frames, the blink lasts as long as the slice.
     void blink_a(uint32_t duration, bool reverse) {
-        _led_a_duration = _max_duration * static_cast<float>(duration) / (kSliceMaxSeconds * kSampleRate);
-        _led_a_duration = std::max(_led_a_duration, _sus_duration);
-        _led_a_decay_treshld = _led_a_duration - _sus_duration;
+        _led_a_duration = std::max(duration_mks(duration), kSusDuration);
+        _led_a_decay_treshld = _led_a_duration - kSusDuration;
+        _led_a_end = daisy::System::GetUs() + _led_a_duration;
         _led_a_rev = reverse;
     }
 
     void blink_b(uint32_t duration, bool reverse) {
-        _led_b_duration = _max_duration * static_cast<float>(duration) / (kSliceMaxSeconds * kSampleRate);
-        _led_b_duration = std::max(_led_b_duration, _sus_duration);
-        _led_b_decay_treshld = _led_b_duration - _sus_duration;
+        _led_b_duration = std::max(duration_mks(duration), kSusDuration);
+        _led_b_decay_treshld = _led_b_duration - kSusDuration;
+        _led_b_end = daisy::System::GetUs() + _led_b_duration;
         _led_b_rev = reverse;
     }
 
@@ -48,23 +50,33 @@ public:
     }
 
     void tick() {
+        auto now = daisy::System::GetUs();
         if (_led_a_duration > 0) {
-            _led_a_duration --;
+            _led_a_duration = remaining(_led_a_end, now);
             _led_a.Set(led_brightness(_led_a_duration, _led_a_decay_treshld, _led_a_rev));
             _led_a.Update();
         }
 
         if (_led_b_duration > 0) {
-            _led_b_duration --;
+            _led_b_duration = remaining(_led_b_end, now);
             _led_b.Set(led_brightness(_led_b_duration, _led_b_decay_treshld, _led_b_rev));
             _led_b.Update();
         }
     }
 
 private:
+    static constexpr uint32_t duration_mks(const uint32_t frames) {
+        return static_cast<uint32_t>(1000000ull * frames / kSampleRate);
+    }
+
+    static inline uint32_t remaining(const uint32_t end, const uint32_t now) {
+        auto left = static_cast<int32_t>(end - now);
+        return left > 0 ? left : 0;
+    }
+
     inline float led_brightness(const uint32_t duration, const float decay_treshld, const bool inv) {
         if (duration == 0) return 0;
-        if (inv) return (duration > _sus_duration) ? 1.f - (duration - _sus_duration) / decay_treshld : 1;
+        if (inv) return (duration > kSusDuration) ? 1.f - (duration - kSusDuration) / decay_treshld : 1;
         return duration > decay_treshld ? 1 : duration / decay_treshld;
     }
 
@@ -74,14 +86,16 @@ private:
 
     uint32_t _led_a_duration = 0;
     uint32_t _led_a_decay_treshld = 0;
+    uint32_t _led_a_end = 0;
     uint32_t _led_b_duration = 0;
     uint32_t _led_b_decay_treshld = 0;
+    uint32_t _led_b_end = 0;
 
     bool _led_a_rev = false;
     bool _led_b_rev = false;
 
-    uint32_t _max_duration = 2634520;
-    uint32_t _sus_duration = 100000;
+    //Microseconds
+    static constexpr uint32_t kSusDuration = 75000;
 };
 
 }
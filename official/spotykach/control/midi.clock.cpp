@@ -0,0 +1,60 @@
+#include "midi.clock.h"
+
+using namespace blptls;
+using namespace spotykach;
+using namespace daisy;
+
+static constexpr size_t kRxBufferSize = 64;
+static uint8_t DMA_BUFFER_MEM_SECTION midi_rx_buffer[kRxBufferSize];
+
+enum : uint8_t {
+    kMidiClock      = 0xF8,
+    kMidiStart      = 0xFA,
+    kMidiContinue   = 0xFB,
+    kMidiStop       = 0xFC
+};
+
+void MidiClock::initialize() {
+    UartHandler::Config cfg;
+    cfg.periph = UartHandler::Config::Peripheral::USART_1;
+    cfg.mode = UartHandler::Config::Mode::RX;
+    cfg.baudrate = 31250;
+    cfg.pin_config.rx = seed::D14;
+    cfg.pin_config.tx = Pin();
+    _uart.Init(cfg);
+    _uart.DmaListenStart(midi_rx_buffer, kRxBufferSize, &MidiClock::on_receive, this);
+}
+
+void MidiClock::on_receive(uint8_t* data, size_t size, void* context, UartHandler::Result result) {
+    if (result != UartHandler::Result::OK) return;
+    static_cast<MidiClock*>(context)->receive(data, size, System::GetUs());
+}
+
+/*
+Called from the DMA interrupt with every chunk of received bytes.
+The last byte arrived just now, the earlier ones a byte duration apart each.
+Everything except clock and transport messages is ignored.
+*/
+void MidiClock::receive(const uint8_t* data, size_t size, uint32_t now) {
+    for (size_t i = 0; i < size; i++) {
+        auto status = data[i];
+        if (status != kMidiClock && status != kMidiStart && status != kMidiContinue && status != kMidiStop) continue;
+        auto next = (_write + 1) % kQueueSize;
+        if (next == _read) return;
+        _queue[_write] = { status, now - static_cast<uint32_t>(size - 1 - i) * kByteMks };
+        _write = next;
+    }
+}
+
+void MidiClock::pull(Clock& clock) {
+    while (_read != _write) {
+        auto e = _queue[_read];
+        _read = (_read + 1) % kQueueSize;
+        switch (e.status) {
+            case kMidiClock:    clock.midi_clock(e.timestamp); break;
+            case kMidiStart:    clock.midi_start(); break;
+            case kMidiContinue: clock.midi_continue(); break;
+            case kMidiStop:     clock.midi_stop(); break;
+        }
+    }
+}
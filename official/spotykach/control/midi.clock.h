@@ -0,0 +1,45 @@
+#pragma once
+
+#include <array>
+#include "daisy_seed.h"
+#include "clock.h"
+
+namespace blptls {
+namespace spotykach {
+
+/*
+MIDI clock and transport input.
+UART is received by DMA, every byte gets a timestamp in the DMA callback.
+Realtime messages are queued there and handed to the Clock from the main loop.
+*/
+class MidiClock {
+public:
+    MidiClock() = default;
+    ~MidiClock() = default;
+
+    void initialize();
+    void pull(Clock& clock);
+
+    //Bytes received by the time now, also how host tests replay streams.
+    void receive(const uint8_t* data, size_t size, uint32_t now);
+
+private:
+    struct Event {
+        uint8_t status;
+        uint32_t timestamp;
+    };
+
+    static void on_receive(uint8_t* data, size_t size, void* context, daisy::UartHandler::Result result);
+
+    //Duration of one byte at 31250 baud, 10 bits per byte.
+    static constexpr uint32_t kByteMks = 320;
+    static constexpr size_t kQueueSize = 64;
+
+    daisy::UartHandler _uart;
+    std::array<Event, kQueueSize> _queue;
+    volatile size_t _write = 0;
+    volatile size_t _read = 0;
+};
+
+}
+}
@@ -0,0 +1,105 @@
+#include "scheduler.h"
+#include "daisy_seed.h"
+#include <assert.h>
+
+using namespace blptls;
+using namespace spotykach;
+using namespace daisy;
+
+static inline bool is_due(uint32_t time, uint32_t now) {
+    return static_cast<int32_t>(now - time) >= 0;
+}
+
+size_t Scheduler::add_polled(const char* name, Task task) {
+    return add({ name, Kind::Polled, task, nullptr, 0, 0, 0, {} });
+}
+
+size_t Scheduler::add_periodic(const char* name, Task task, uint32_t period_mks, uint32_t budget_mks) {
+    return add({ name, Kind::Periodic, task, nullptr, period_mks, budget_mks, System::GetUs(), {} });
+}
+
+size_t Scheduler::add_background(const char* name, Job job, uint32_t budget_mks) {
+    return add({ name, Kind::Background, nullptr, job, 0, budget_mks, 0, {} });
+}
+
+size_t Scheduler::add(Entry entry) {
+    assert(_count < kMaxTasks);
+    _tasks[_count] = entry;
+    _last_poll = System::GetUs();
+    return _count++;
+}
+
+void Scheduler::run() {
+    _last_poll = System::GetUs();
+    while (true) pass();
+}
+
+/*
+One pass runs the polled tasks, every periodic task that's due
+and a slice of one background job, polling between all of them.
+*/
+void Scheduler::pass() {
+    poll();
+    for (size_t i = 0; i < _count; i++) {
+        auto& entry = _tasks[i];
+        if (entry.kind != Kind::Periodic) continue;
+        auto now = System::GetUs();
+        if (!is_due(entry.next_due, now)) continue;
+        run_periodic(entry, now);
+        poll();
+    }
+    for (size_t n = 0; n < _count; n++) {
+        auto& entry = _tasks[_next_job];
+        _next_job = (_next_job + 1) % _count;
+        if (entry.kind != Kind::Background) continue;
+        run_background(entry);
+        break;
+    }
+}
+
+void Scheduler::poll() {
+    auto now = System::GetUs();
+    auto gap = now - _last_poll;
+    if (gap > _max_poll_gap_mks) _max_poll_gap_mks = gap;
+    for (size_t i = 0; i < _count; i++) {
+        auto& entry = _tasks[i];
+        if (entry.kind != Kind::Polled) continue;
+        auto start = System::GetUs();
+        entry.task();
+        account(entry, System::GetUs() - start);
+    }
+    _last_poll = now;
+}
+
+//Fixed rate: a late run doesn't shift the ones after it, unless it's a whole period late.
+void Scheduler::run_periodic(Entry& entry, uint32_t now) {
+    entry.task();
+    account(entry, System::GetUs() - now);
+    entry.next_due += entry.period_mks;
+    if (is_due(entry.next_due, now)) {
+        entry.stats.late++;
+        entry.next_due = now + entry.period_mks;
+    }
+}
+
+//A step isn't started if the previous one wouldn't fit into what's left of the budget.
+void Scheduler::run_background(Entry& entry) {
+    auto start = System::GetUs();
+    auto more = true;
+    do {
+        auto step_start = System::GetUs();
+        more = entry.job();
+        account(entry, System::GetUs() - step_start);
+        poll();
+    } while (more && System::GetUs() - start + entry.stats.last_mks <= entry.budget_mks);
+    if (System::GetUs() - start > entry.budget_mks) entry.stats.over_budget++;
+}
+
+void Scheduler::account(Entry& entry, uint32_t duration) {
+    auto& stats = entry.stats;
+    stats.runs++;
+    stats.last_mks = duration;
+    stats.total_mks += duration;
+    if (duration > stats.max_mks) stats.max_mks = duration;
+    if (entry.kind == Kind::Periodic && duration > entry.budget_mks) stats.over_budget++;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <array>
+#include <functional>
+#include <stdint.h>
+#include <stddef.h>
+
+namespace blptls {
+namespace spotykach {
+
+/*
+Runtime of one task, read it with the debugger.
+late - periodic runs that started a whole period or more behind.
+over_budget - runs, or job slices, that took longer than the budget.
+*/
+struct TaskStats {
+    uint32_t runs;
+    uint32_t late;
+    uint32_t over_budget;
+    uint32_t last_mks;
+    uint32_t max_mks;
+    uint64_t total_mks;
+};
+
+/*
+Cooperative main loop. Three kinds of tasks:
+polled - run before every other task, e.g. clock polling and LED PWM,
+so their rate depends on the longest single task or job step only;
+periodic - run to completion at a fixed rate;
+background - jobs that do a bounded piece of work per call and return
+true while there is more; a job keeps being called until it's done
+or its budget for the pass is used, the jobs take turns across passes.
+Nothing is preempted: a budget tells how long a task is supposed to take,
+the stats tell how long it did.
+*/
+class Scheduler {
+public:
+    using Task = std::function<void()>;
+    using Job = std::function<bool()>;
+
+    static constexpr size_t kMaxTasks = 12;
+
+    Scheduler() = default;
+    ~Scheduler() = default;
+
+    size_t add_polled(const char* name, Task task);
+    size_t add_periodic(const char* name, Task task, uint32_t period_mks, uint32_t budget_mks);
+    size_t add_background(const char* name, Job job, uint32_t budget_mks);
+
+    [[noreturn]] void run();
+    void pass();
+
+    const TaskStats& stats(size_t id) const { return _tasks[id].stats; }
+    //Longest time between two polls, the worst case polled tasks have seen.
+    uint32_t max_poll_gap_mks() const { return _max_poll_gap_mks; }
+
+private:
+    enum class Kind {
+        Polled,
+        Periodic,
+        Background
+    };
+
+    struct Entry {
+        const char* name;
+        Kind kind;
+        Task task;
+        Job job;
+        uint32_t period_mks;
+        uint32_t budget_mks;
+        uint32_t next_due;
+        TaskStats stats;
+    };
+
+    size_t add(Entry entry);
+    void poll();
+    void run_periodic(Entry& entry, uint32_t now);
+    void run_background(Entry& entry);
+    static void account(Entry& entry, uint32_t duration);
+
+    std::array<Entry, kMaxTasks> _tasks;
+    size_t _count = 0;
+    size_t _next_job = 0;
+    uint32_t _last_poll = 0;
+    uint32_t _max_poll_gap_mks = 0;
+};
+
+}
+}
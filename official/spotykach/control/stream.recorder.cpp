@@ -0,0 +1,179 @@
+#include "stream.recorder.h"
+
+#if SPOTYKACH_STREAM_RECORDER || defined(TEST)
+
+#include <stdio.h>
+#include <algorithm>
+#include "daisy_seed.h"
+#include "../core/globals.h"
+
+using namespace blptls;
+using namespace spotykach;
+using namespace daisy;
+
+//Ring and chunk lengths are powers of two, so a chunk never wraps.
+static constexpr uint32_t kRingFrames = kRecorderRingFrames;
+static constexpr uint32_t kRingMask = kRingFrames - 1;
+static constexpr uint32_t kChunkFrames = 512;
+static constexpr uint32_t kChunksPerSync = 10 * kSampleRate / kChunkFrames;
+static constexpr uint32_t kHeaderSize = 44;
+
+static uint32_t DSY_SDRAM_BSS recorder_ring[kRingFrames];
+
+//Card DMA can't reach DTCM or D2 SRAM, this stays in AXI SRAM.
+static uint32_t recorder_chunk[kChunkFrames];
+
+static inline uint32_t pack(float l, float r) {
+    auto s16 = [](float v) {
+        v = v > 1.f ? 1.f : (v < -1.f ? -1.f : v);
+        return static_cast<uint16_t>(static_cast<int16_t>(v * 32767.f));
+    };
+    return s16(l) | (static_cast<uint32_t>(s16(r)) << 16);
+}
+
+#if SPOTYKACH_STREAM_RECORDER
+
+class CardSink: public RecorderSink {
+public:
+    //Picks the first free SPK_NNNN.WAV name.
+    bool open() {
+        SdmmcHandler::Config cfg;
+        cfg.Defaults();
+        if (_sd.Init(cfg) != SdmmcHandler::Result::OK ||
+            _fsi.Init(FatFSInterface::Config::MEDIA_SD) != FatFSInterface::Result::OK ||
+            f_mount(&_fsi.GetSDFileSystem(), _fsi.GetSDPath(), 1) != FR_OK) {
+            return false;
+        }
+        char name[32];
+        FILINFO info;
+        for (int i = 0; i < 10000; i++) {
+            snprintf(name, sizeof(name), "%sSPK_%04d.WAV", _fsi.GetSDPath(), i);
+            if (f_stat(name, &info) != FR_NO_FILE) continue;
+            return f_open(&_file, name, FA_CREATE_ALWAYS | FA_WRITE) == FR_OK &&
+                f_lseek(&_file, kHeaderSize) == FR_OK;
+        }
+        return false;
+    }
+
+    bool write(const void* data, uint32_t bytes) override {
+        UINT written;
+        return f_write(&_file, data, bytes, &written) == FR_OK && written == bytes;
+    }
+
+    bool write_header(const void* header, uint32_t bytes) override {
+        auto end = f_tell(&_file);
+        return f_lseek(&_file, 0) == FR_OK && write(header, bytes) && f_lseek(&_file, end) == FR_OK;
+    }
+
+    bool sync() override { return f_sync(&_file) == FR_OK; }
+    void close() override { f_close(&_file); }
+
+private:
+    SdmmcHandler _sd;
+    FatFSInterface _fsi;
+    FIL _file;
+};
+
+static CardSink recorder_card;
+
+void StreamRecorder::initialize(Tap tap) {
+    if (!recorder_card.open()) {
+        _tap = tap;
+        _stats.errors++;
+        return;
+    }
+    initialize(tap, recorder_card);
+}
+
+#endif
+
+void StreamRecorder::initialize(Tap tap, RecorderSink& sink) {
+    _tap = tap;
+    _sink = &sink;
+    if (!write_header()) {
+        _stats.errors++;
+        return;
+    }
+    _is_recording = true;
+}
+
+bool StreamRecorder::write_header() {
+    uint32_t data_size = _stats.written_frames * 4;
+    uint32_t header[kHeaderSize / 4] = {
+        0x46464952,                 //"RIFF"
+        data_size + kHeaderSize - 8,
+        0x45564157,                 //"WAVE"
+        0x20746d66,                 //"fmt "
+        16,
+        1 | (2 << 16),              //PCM, stereo
+        kSampleRate,
+        kSampleRate * 4,
+        4 | (16 << 16),             //block align, bits per sample
+        0x61746164,                 //"data"
+        data_size
+    };
+    return _sink->write_header(header, kHeaderSize);
+}
+
+/*
+Called from the audio callback. A block that doesn't fit
+is dropped whole and accounted, the ring is never overwritten.
+*/
+void StreamRecorder::write(const float* const* in, const float* const* out, size_t size) {
+    if (!_is_recording) return;
+    auto w = _write;
+    if (kRingFrames - (w - _read) < size) {
+        _stats.dropped_frames += size;
+        _stats.overruns++;
+        return;
+    }
+    auto buf = _tap == Tap::Input ? in : out;
+    //Input is mono, see Core::process.
+    auto right = _tap == Tap::Input ? buf[0] : buf[1];
+    for (size_t f = 0; f < size; f++) recorder_ring[(w + f) & kRingMask] = pack(buf[0][f], right[f]);
+    _write = w + size;
+}
+
+/*
+Writes one 2 KB chunk per call and returns true while another one waits,
+so the scheduler gets to the other tasks between writes.
+The header is refreshed every 10 seconds, so cutting the power
+loses no more than that.
+*/
+bool StreamRecorder::pull() {
+    if (!_is_recording) return false;
+    auto r = _read;
+    auto fill = _write - r;
+    if (fill > _stats.max_fill) _stats.max_fill = fill;
+    if (fill < kChunkFrames) return false;
+
+    std::copy(recorder_ring + (r & kRingMask), recorder_ring + (r & kRingMask) + kChunkFrames, recorder_chunk);
+    _read = r + kChunkFrames;
+
+    auto start = System::GetUs();
+    auto is_written = _sink->write(recorder_chunk, sizeof(recorder_chunk));
+    auto duration = System::GetUs() - start;
+    if (duration > _stats.max_write_mks) _stats.max_write_mks = duration;
+    if (!is_written) {
+        _stats.errors++;
+        stop();
+        return false;
+    }
+    _stats.written_frames += kChunkFrames;
+    if (++_chunks_since_sync == kChunksPerSync) sync();
+    return _write - _read >= kChunkFrames;
+}
+
+void StreamRecorder::sync() {
+    _chunks_since_sync = 0;
+    if (!write_header() || !_sink->sync()) _stats.errors++;
+}
+
+void StreamRecorder::stop() {
+    if (!_is_recording) return;
+    _is_recording = false;
+    sync();
+    _sink->close();
+}
+
+#endif
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+SD card pins (D1 - D6) are shared with the panel on the current hardware
+(rec LED, reverse and split toggles), so the recorder is built on demand:
+USE_FATFS = 1 and C_DEFS += -DSPOTYKACH_STREAM_RECORDER=1 in the Makefile.
+
+A card write blocks the main loop till the card is done with it. Writes
+are 2 KB and usually take well under a millisecond, but a card erasing
+a block or FatFS growing the FAT holds a single write for tens of
+milliseconds: the clock input, MIDI and the controls are polled that much
+later meanwhile, see max_write_mks. Audio isn't affected.
+*/
+#ifndef SPOTYKACH_STREAM_RECORDER
+#define SPOTYKACH_STREAM_RECORDER 0
+#endif
+
+namespace blptls {
+namespace spotykach {
+
+/*
+Where the recording goes: a WAV file on the SD card, see stream.recorder.cpp,
+or a file on the host.
+*/
+class RecorderSink {
+public:
+    virtual ~RecorderSink() = default;
+
+    //Appends to the data.
+    virtual bool write(const void* data, uint32_t bytes) = 0;
+    //Overwrites the start of the file, the next write appends again.
+    virtual bool write_header(const void* header, uint32_t bytes) = 0;
+    virtual bool sync() = 0;
+    virtual void close() = 0;
+};
+
+struct RecorderStats {
+    uint32_t written_frames;
+    uint32_t dropped_frames;
+    uint32_t overruns;      //audio blocks that didn't fit into the ring
+    uint32_t max_fill;      //frames waiting in the ring, worst case
+    uint32_t max_write_mks; //longest single card write
+    uint32_t errors;
+};
+
+/*
+Continuous 16-bit stereo WAV capture to the SD card.
+The audio callback packs frames into a lock-free ring in SDRAM,
+the main loop drains it to the sink in whole chunks.
+The ring holds over a second of audio, which covers card write stalls;
+the stats tell how close the worst stall came to the limit.
+*/
+class StreamRecorder {
+public:
+    enum class Tap {
+        Input,
+        Output
+    };
+
+    StreamRecorder() = default;
+    ~StreamRecorder() = default;
+
+    //Records to a new file on the SD card.
+    void initialize(Tap tap);
+    //sink is opened, its data starts after the header.
+    void initialize(Tap tap, RecorderSink& sink);
+
+    //Audio callback side.
+    void write(const float* const* in, const float* const* out, size_t size);
+
+    //Main loop side, pull() is a background job.
+    bool pull();
+    void stop();
+
+    bool is_recording() const { return _is_recording; }
+    const RecorderStats& stats() const { return _stats; }
+
+private:
+    bool write_header();
+    void sync();
+
+    Tap _tap = Tap::Output;
+    RecorderSink* _sink = nullptr;
+    volatile bool _is_recording = false;
+    volatile uint32_t _write = 0;
+    volatile uint32_t _read = 0;
+    uint32_t _chunks_since_sync = 0;
+    RecorderStats _stats {};
+};
+
+}
+}
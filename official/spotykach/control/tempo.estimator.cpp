@@ -0,0 +1,144 @@
+#include "tempo.estimator.h"
+#include "daisy_seed.h"
+#include <algorithm>
+
+using namespace blptls;
+using namespace spotykach;
+using namespace daisy;
+
+//Shorter takes hold too few beats to tell the tempo.
+static constexpr size_t kMinHops = static_cast<size_t>(2 * Onsets::kHopsPerSecond);
+static constexpr size_t kMaxBeats = 8;
+static constexpr float kCenterTempo = 120;
+static constexpr float kOctaveWidth = 1;
+//Below it the take has no steady pulse and the clock is left alone.
+static constexpr float kMinConfidence = 0.15f;
+
+void TempoEstimator::initialize() {
+    _fft.initialize();
+}
+
+void TempoEstimator::pull(const Core& core, Clock& clock) {
+    if (_stage == Stage::Idle) {
+        for (size_t i = 0; i < kEnginesCount; i++) {
+            auto& onsets = core.engineAt(i).onsets();
+            auto takes = onsets.takes();
+            if (takes == _takes[i]) continue;
+            _takes[i] = takes;
+            if (onsets.is_recording() || onsets.size() < kMinHops) continue;
+            _onsets = &onsets;
+            _stage = Stage::Copy;
+            _job_mks = 0;
+            break;
+        }
+        return;
+    }
+    //A new take is overwriting the envelope, it's estimated once it's over.
+    if (_onsets->is_recording()) {
+        _stats.cancelled++;
+        _stage = Stage::Idle;
+        return;
+    }
+    auto start = System::GetUs();
+    step(clock);
+    auto duration = System::GetUs() - start;
+    _job_mks += duration;
+    if (duration > _stats.max_step_mks) _stats.max_step_mks = duration;
+}
+
+void TempoEstimator::step(Clock& clock) {
+    switch (_stage) {
+        case Stage::Idle: break;
+        case Stage::Copy:
+            copy();
+            _stage = Stage::Forward;
+            break;
+        case Stage::Forward:
+            _fft.forward(_signal.data(), _spectrum.data());
+            _stage = Stage::Power;
+            break;
+        case Stage::Power:
+            power();
+            _stage = Stage::Inverse;
+            break;
+        case Stage::Inverse:
+            _fft.inverse(_spectrum.data(), _signal.data());
+            _candidate = 0;
+            _best_tempo = 0;
+            _best_score = 0;
+            _stage = Stage::Search;
+            break;
+        case Stage::Search:
+            search();
+            if (_candidate == kCandidates) finish(clock);
+            break;
+    }
+}
+
+void TempoEstimator::copy() {
+    _hops = _onsets->size();
+    float mean = 0;
+    for (size_t i = 0; i < _hops; i++) mean += _onsets->at(i);
+    mean /= _hops;
+    for (size_t i = 0; i < _hops; i++) _signal[i] = _onsets->at(i) - mean;
+    std::fill(_signal.begin() + _hops, _signal.end(), 0.f);
+}
+
+//Power spectrum in the packed format, its inverse is the autocorrelation.
+void TempoEstimator::power() {
+    _spectrum[0] *= _spectrum[0];
+    _spectrum[1] *= _spectrum[1];
+    for (size_t k = 2; k < kSize; k += 2) {
+        _spectrum[k] = _spectrum[k] * _spectrum[k] + _spectrum[k + 1] * _spectrum[k + 1];
+        _spectrum[k + 1] = 0;
+    }
+}
+
+/*
+Onsets rarely fall on hop boundaries, so one is split between two hops
+differently on every beat and the autocorrelation peak of a beat
+that isn't a whole number of hops is spread over the neighbouring lags.
+Averaging three lags around it keeps such beats from losing
+to the multiples that happen to be whole.
+*/
+float TempoEstimator::correlation(float lag) const {
+    return (sample(lag - 1) + sample(lag) + sample(lag + 1)) / 3;
+}
+
+//Autocorrelation per overlapping hop, so long lags aren't penalised.
+float TempoEstimator::sample(float lag) const {
+    auto i = static_cast<size_t>(lag);
+    auto f = lag - i;
+    auto a = _signal[i] / (_hops - i);
+    auto b = _signal[i + 1] / (_hops - i - 1);
+    return a + f * (b - a);
+}
+
+void TempoEstimator::search() {
+    auto last = std::min(_candidate + kCandidatesPerStep, kCandidates);
+    for (; _candidate < last; _candidate++) {
+        auto tempo = kTempoMin + _candidate * kTempoStep;
+        auto lag = kSecondsPerMinute * Onsets::kHopsPerSecond / tempo;
+        //Half of the take at most, so every lag has enough overlap.
+        auto beats = std::min(static_cast<size_t>(_hops / 2 / lag), kMaxBeats);
+        if (beats == 0) continue;
+        float sum = 0;
+        for (size_t k = 1; k <= beats; k++) sum += correlation(k * lag);
+        auto octaves = log2f(tempo / kCenterTempo) / kOctaveWidth;
+        auto score = sum / beats * expf(-0.5f * octaves * octaves);
+        if (score > _best_score) {
+            _best_score = score;
+            _best_tempo = tempo;
+        }
+    }
+}
+
+void TempoEstimator::finish(Clock& clock) {
+    auto energy = sample(0);
+    _stats.confidence = energy > 0 ? _best_score / energy : 0;
+    _stats.tempo = _best_tempo;
+    _stats.estimates++;
+    _stats.last_mks = _job_mks;
+    _stage = Stage::Idle;
+    if (_stats.confidence >= kMinConfidence) clock.propose_tempo(_best_tempo);
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <array>
+#include <stdint.h>
+#include <stddef.h>
+#include "../core/core.h"
+#include "../fx/rfft.h"
+#include "clock.h"
+
+namespace blptls {
+namespace spotykach {
+
+/*
+Estimator runtime and the last result, read them with the debugger.
+last_mks - main loop time the last estimate took, summed over its steps.
+*/
+struct TempoStats {
+    uint32_t estimates;
+    uint32_t cancelled;
+    uint32_t last_mks;
+    uint32_t max_step_mks;
+    float tempo;
+    float confidence;
+};
+
+/*
+Finds the tempo of a take once its recording stops and sets it
+on the clock, unless the clock follows an external one.
+The onset envelope of the take is autocorrelated through the FFT,
+then the tempos in range are scored by the autocorrelation at
+their beat and its multiples, weighted towards 120 bpm
+to settle on one of the octaves.
+The work is done in steps, one per main loop pass, each well under
+a millisecond, so the knobs and the clock input aren't held up.
+*/
+class TempoEstimator {
+public:
+    TempoEstimator() = default;
+    ~TempoEstimator() = default;
+
+    void initialize();
+
+    //Main loop side.
+    void pull(const Core& core, Clock& clock);
+
+    bool is_busy() const { return _stage != Stage::Idle; }
+    const TempoStats& stats() const { return _stats; }
+
+private:
+    enum class Stage {
+        Idle,
+        Copy,
+        Forward,
+        Power,
+        Inverse,
+        Search
+    };
+
+    //Twice the longest envelope, so the autocorrelation doesn't wrap.
+    static constexpr size_t kSize = 4096;
+    static_assert(kSize >= 2 * Onsets::kHops, "Tempo FFT is too short for the source");
+
+    static constexpr float kTempoStep = 0.5f;
+    static constexpr size_t kCandidates = static_cast<size_t>((kTempoMax - kTempoMin) / kTempoStep) + 1;
+    static constexpr size_t kCandidatesPerStep = 32;
+
+    void step(Clock& clock);
+    void copy();
+    void power();
+    void search();
+    void finish(Clock& clock);
+    float correlation(float lag) const;
+    float sample(float lag) const;
+
+    RealFFT<kSize> _fft;
+    std::array<float, kSize> _signal;
+    std::array<float, kSize> _spectrum;
+
+    const Onsets* _onsets = nullptr;
+    std::array<uint32_t, kEnginesCount> _takes {};
+    Stage _stage = Stage::Idle;
+    size_t _hops = 0;
+    size_t _candidate = 0;
+    float _best_tempo = 0;
+    float _best_score = 0;
+    uint32_t _job_mks = 0;
+    TempoStats _stats {};
+};
+
+}
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace blptls {
+namespace spotykach {
+
+enum class AccessComponent: uint8_t {
+    Source,
+    SliceBuffer,
+    FxEngine,
+    Count
+};
+
+}
+}
+
+/*
+Memory access hooks on the audio path, compiled out unless
+SPOTYKACH_ACCESS_TRACE is defined. That's meant for a host build,
+which defines access_trace() and either logs the accesses
+or replays them through a CacheModel.
+*/
+#ifdef SPOTYKACH_ACCESS_TRACE
+
+namespace blptls {
+namespace spotykach {
+void access_trace(AccessComponent component, const void* address, size_t bytes, bool write);
+}
+}
+
+#define TRACE_READ(component, pointer) \
+    ::blptls::spotykach::access_trace(::blptls::spotykach::AccessComponent::component, pointer, sizeof(*(pointer)), false)
+#define TRACE_WRITE(component, pointer) \
+    ::blptls::spotykach::access_trace(::blptls::spotykach::AccessComponent::component, pointer, sizeof(*(pointer)), true)
+
+#else
+
+#define TRACE_READ(component, pointer) ((void)0)
+#define TRACE_WRITE(component, pointer) ((void)0)
+
+#endif
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <array>
+#include <stdint.h>
+#include <stddef.h>
+
+namespace blptls {
+namespace spotykach {
+
+/*
+Two level bitset. Every bit of the upper level tells
+whether the corresponding word of the lower level has any bit set,
+so searching for the closest set bit touches a few words only.
+*/
+template <size_t kBits>
+class BitIndex {
+public:
+    static constexpr size_t kNone = SIZE_MAX;
+
+    BitIndex() { reset(); }
+
+    void reset() {
+        _words.fill(0);
+        _summary.fill(0);
+    }
+
+    void set(size_t bit, bool value) {
+        auto w = bit >> 5;
+        auto mask = 1u << (bit & 31);
+        if (value) _words[w] |= mask;
+        else _words[w] &= ~mask;
+        auto s_mask = 1u << (w & 31);
+        if (_words[w]) _summary[w >> 5] |= s_mask;
+        else _summary[w >> 5] &= ~s_mask;
+    }
+
+    bool test(size_t bit) const {
+        return _words[bit >> 5] & (1u << (bit & 31));
+    }
+
+    //First set bit at or after the given one, kNone if there is none.
+    size_t next(size_t bit) const {
+        if (bit >= kBits) return kNone;
+        auto w = bit >> 5;
+        uint32_t word = _words[w] & (~0u << (bit & 31));
+        if (word) return (w << 5) + __builtin_ctz(word);
+        w = next_word(w + 1);
+        return w == kNone ? kNone : (w << 5) + __builtin_ctz(_words[w]);
+    }
+
+    //Last set bit at or before the given one, kNone if there is none.
+    size_t prev(size_t bit) const {
+        if (bit >= kBits) bit = kBits - 1;
+        auto w = bit >> 5;
+        uint32_t word = _words[w] & (~0u >> (31 - (bit & 31)));
+        if (word) return (w << 5) + 31 - __builtin_clz(word);
+        if (w == 0) return kNone;
+        w = prev_word(w - 1);
+        return w == kNone ? kNone : (w << 5) + 31 - __builtin_clz(_words[w]);
+    }
+
+    //Closest set bit within the distance, kNone if there is none.
+    size_t nearest(size_t bit, size_t distance) const {
+        auto n = next(bit);
+        auto p = prev(bit);
+        auto n_dist = n == kNone ? kNone : n - bit;
+        auto p_dist = p == kNone ? kNone : bit - p;
+        if (n_dist <= p_dist) return n_dist <= distance ? n : kNone;
+        return p_dist <= distance ? p : kNone;
+    }
+
+private:
+    static constexpr size_t kWords = (kBits + 31) / 32;
+    static constexpr size_t kSummaryWords = (kWords + 31) / 32;
+
+    size_t next_word(size_t w) const {
+        if (w >= kWords) return kNone;
+        auto s = w >> 5;
+        uint32_t word = _summary[s] & (~0u << (w & 31));
+        while (!word) {
+            if (++s == kSummaryWords) return kNone;
+            word = _summary[s];
+        }
+        return (s << 5) + __builtin_ctz(word);
+    }
+
+    size_t prev_word(size_t w) const {
+        auto s = w >> 5;
+        uint32_t word = _summary[s] & (~0u >> (31 - (w & 31)));
+        while (!word) {
+            if (s-- == 0) return kNone;
+            word = _summary[s];
+        }
+        return (s << 5) + 31 - __builtin_clz(word);
+    }
+
+    std::array<uint32_t, kWords> _words;
+    std::array<uint32_t, kSummaryWords> _summary;
+};
+
+}
+}
@@ -0,0 +1,31 @@
+#include "buffers.h"
+
+namespace blptls {
+namespace spotykach {
+
+float DSY_SDRAM_BSS _srcBufs[kEnginesCount * kSourceSlots * kChannelsCount][kSourceBufferLength];
+
+float DSY_SDRAM_BSS _slice_arena_bufs[kEnginesCount * kChannelsCount][kSliceArenaLength];
+
+SlicePitchCell SLICE_PITCH_MEMORY _slc_pitch_bufs[kSlicesCount * kEnginesCount][_pitch_buf_length];
+ContinualPitchCell CONTINUAL_PITCH_MEMORY _ctn_pitch_bufs[kEnginesCount][_pitch_buf_length];
+
+uint16_t REVERB_MEMORY _reverb_buf[kReverbMemorySize];
+
+LevelCell DSY_SDRAM_BSS _level_bufs[kEnginesCount * kSourceSlots][kLevelCellsLength];
+
+float DSY_SDRAM_BSS _history_bufs[kEnginesCount * kChannelsCount][kHistoryPagesCount * kHistoryPageLength];
+
+//What's placed in SDRAM, the stream recorder's ring is counted by its size.
+static_assert(sizeof(_srcBufs) + sizeof(_level_bufs) + sizeof(_history_bufs) + sizeof(_slice_arena_bufs)
+    + (is_in_sdram(SPOTYKACH_STRING(SLICE_PITCH_MEMORY)) ? sizeof(_slc_pitch_bufs) : 0)
+    + (is_in_sdram(SPOTYKACH_STRING(CONTINUAL_PITCH_MEMORY)) ? sizeof(_ctn_pitch_bufs) : 0)
+    + (is_in_sdram(SPOTYKACH_STRING(REVERB_MEMORY)) ? sizeof(_reverb_buf) : 0)
+#if SPOTYKACH_STREAM_RECORDER
+    + kRecorderRingFrames * sizeof(uint32_t)
+#endif
+    <= kSdramSize,
+    "Buffers don't fit into SDRAM, lower SPOTYKACH_SOURCE_SLOTS or kUndoSources");
+
+}
+}
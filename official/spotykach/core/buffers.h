@@ -4,47 +4,112 @@
 #include "dev/sdram.h"
 #include "daisy_seed.h"
 #include "globals.h"
+#include "../fx/mi/fx_engine.h"
+#include "peak.pyramid.h"
 
 namespace blptls {
 namespace spotykach {
 
-static const size_t kSourceBufferLength = kSourceMaxSeconds * kSampleRate;
-static const size_t kSliceBufferLength = kSliceMaxSeconds * kSampleRate;
+/*
+Pitch shifter delay memory. Sample format (FORMAT_12_BIT, FORMAT_16_BIT, FORMAT_32_BIT)
+and placement (DSY_SDRAM_BSS, DTCM_MEM_SECTION or nothing for AXI SRAM) are chosen
+at build time, separately for slice voices and continual playback, e.g.
+C_DEFS += -DSLICE_PITCH_FORMAT=FORMAT_32_BIT -DSLICE_PITCH_MEMORY=DTCM_MEM_SECTION
+One shifter takes 8 KB in 12/16-bit formats and 16 KB in 32-bit, so the 6 slice
+and 2 continual shifters all in 32-bit take 128 KB, more than the DTCM has
+next to the stack. Cost and noise floor per format, see host/bench/pitch.shift.cpp
+*/
+#ifndef SLICE_PITCH_FORMAT
+#define SLICE_PITCH_FORMAT FORMAT_16_BIT
+#endif
+#ifndef SLICE_PITCH_MEMORY
+#define SLICE_PITCH_MEMORY DSY_SDRAM_BSS
+#endif
+#ifndef CONTINUAL_PITCH_FORMAT
+#define CONTINUAL_PITCH_FORMAT FORMAT_16_BIT
+#endif
+#ifndef CONTINUAL_PITCH_MEMORY
+#define CONTINUAL_PITCH_MEMORY DSY_SDRAM_BSS
+#endif
+//Reverb delay memory, 128 KB at 48 kHz, placed the same way.
+#ifndef REVERB_MEMORY
+#define REVERB_MEMORY DSY_SDRAM_BSS
+#endif
+
+static constexpr clouds::Format kSlicePitchFormat = clouds::SLICE_PITCH_FORMAT;
+static constexpr clouds::Format kContinualPitchFormat = clouds::CONTINUAL_PITCH_FORMAT;
+using SlicePitchCell = clouds::DataType<kSlicePitchFormat>::T;
+using ContinualPitchCell = clouds::DataType<kContinualPitchFormat>::T;
 
-static float DSY_SDRAM_BSS _srcBuf1L[kSourceBufferLength];
-static float DSY_SDRAM_BSS _srcBuf1R[kSourceBufferLength];
+static const int _pitch_buf_length { 4096 };
+
+static const size_t kLevelCellsLength = PeakPyramid<kSourceBufferLength>::kCells0;
+
+static const size_t kHistoryPageLength = PeakPyramid<0>::kHop * PeakPyramid<0>::kFan;
+static const size_t kHistoryPagesCount = kUndoSources * ((kSourceBufferLength + kHistoryPageLength - 1) / kHistoryPageLength);
 
-static float DSY_SDRAM_BSS _srcBuf2L[kSourceBufferLength];
-static float DSY_SDRAM_BSS _srcBuf2R[kSourceBufferLength];
+/*
+SDRAM budget. The pitch shifters and the reverb count only if they are
+placed there, which is told by what their placement macro expands to.
+Source slots take what the rest leaves, at least one,
+SPOTYKACH_SOURCE_SLOTS overrides the count.
+*/
+#define SPOTYKACH_STRING_(x) #x
+#define SPOTYKACH_STRING(x) SPOTYKACH_STRING_(x)
 
-static float DSY_SDRAM_BSS _slcBuf1L[kSliceBufferLength];
-static float DSY_SDRAM_BSS _slcBuf1R[kSliceBufferLength];
+static constexpr bool is_same_placement(const char* a, const char* b) {
+    return *a == *b && (*a == 0 || is_same_placement(a + 1, b + 1));
+}
 
-static float DSY_SDRAM_BSS _slcBuf2L[kSliceBufferLength];
-static float DSY_SDRAM_BSS _slcBuf2R[kSliceBufferLength];
+static constexpr bool is_in_sdram(const char* placement) {
+    return is_same_placement(placement, SPOTYKACH_STRING(DSY_SDRAM_BSS));
+}
 
-static float DSY_SDRAM_BSS _slcBuf3L[kSliceBufferLength];
-static float DSY_SDRAM_BSS _slcBuf3R[kSliceBufferLength];
+static const size_t kSdramSize = 64 * 1024 * 1024;
 
-static float DSY_SDRAM_BSS _slcBuf4L[kSliceBufferLength];
-static float DSY_SDRAM_BSS _slcBuf4R[kSliceBufferLength];
+static constexpr size_t kSlotSdramBytes = kEnginesCount * (kChannelsCount * kSourceBufferLength * sizeof(float)
+    + kLevelCellsLength * sizeof(LevelCell));
 
-static float DSY_SDRAM_BSS _slcBuf5L[kSliceBufferLength];
-static float DSY_SDRAM_BSS _slcBuf5R[kSliceBufferLength];
+static constexpr size_t kSlicePitchBytes = kSlicesCount * kEnginesCount * _pitch_buf_length * sizeof(SlicePitchCell);
+static constexpr size_t kContinualPitchBytes = kEnginesCount * _pitch_buf_length * sizeof(ContinualPitchCell);
+static constexpr size_t kReverbBytes = kReverbMemorySize * sizeof(uint16_t);
 
-static float DSY_SDRAM_BSS _slcBuf6L[kSliceBufferLength];
-static float DSY_SDRAM_BSS _slcBuf6R[kSliceBufferLength];
+static constexpr size_t kFixedSdramBytes =
+    kEnginesCount * kChannelsCount * (kSliceArenaLength + kHistoryPagesCount * kHistoryPageLength) * sizeof(float)
+    + (is_in_sdram(SPOTYKACH_STRING(SLICE_PITCH_MEMORY)) ? kSlicePitchBytes : 0)
+    + (is_in_sdram(SPOTYKACH_STRING(CONTINUAL_PITCH_MEMORY)) ? kContinualPitchBytes : 0)
+    + (is_in_sdram(SPOTYKACH_STRING(REVERB_MEMORY)) ? kReverbBytes : 0)
+#if SPOTYKACH_STREAM_RECORDER
+    + kRecorderRingFrames * sizeof(uint32_t)
+#endif
+    ;
 
-static const int _pitch_buf_length { 4096 };
+#ifdef SPOTYKACH_SOURCE_SLOTS
+static const uint32_t kSourceSlots { SPOTYKACH_SOURCE_SLOTS };
+#else
+static constexpr uint32_t kSourceSlots = kFixedSdramBytes + kSlotSdramBytes < kSdramSize
+    ? (kSdramSize - kFixedSdramBytes) / kSlotSdramBytes
+    : 1;
+#endif
+static_assert(kSourceSlots > 0, "A source needs a slot");
+
+//Defined in buffers.cpp, once for the whole image.
+
+//Left and right of every source slot of every engine.
+extern float _srcBufs[kEnginesCount * kSourceSlots * kChannelsCount][kSourceBufferLength];
+
+//Left and right slice arena of every engine, see SliceArena.
+extern float _slice_arena_bufs[kEnginesCount * kChannelsCount][kSliceArenaLength];
+
+extern SlicePitchCell _slc_pitch_bufs[kSlicesCount * kEnginesCount][_pitch_buf_length];
+extern ContinualPitchCell _ctn_pitch_bufs[kEnginesCount][_pitch_buf_length];
+
+extern uint16_t _reverb_buf[kReverbMemorySize];
+
+extern LevelCell _level_bufs[kEnginesCount * kSourceSlots][kLevelCellsLength];
 
-static uint16_t DSY_SDRAM_BSS _pitch_buf_1[_pitch_buf_length];
-static uint16_t DSY_SDRAM_BSS _pitch_buf_2[_pitch_buf_length];
-static uint16_t DSY_SDRAM_BSS _pitch_buf_3[_pitch_buf_length];
-static uint16_t DSY_SDRAM_BSS _pitch_buf_4[_pitch_buf_length];
-static uint16_t DSY_SDRAM_BSS _pitch_buf_5[_pitch_buf_length];
-static uint16_t DSY_SDRAM_BSS _pitch_buf_6[_pitch_buf_length];
-static uint16_t DSY_SDRAM_BSS _pitch_buf_7[_pitch_buf_length];
-static uint16_t DSY_SDRAM_BSS _pitch_buf_8[_pitch_buf_length];
+//Undo pages of every engine, shared by its source slots, see SourceBank.
+extern float _history_bufs[kEnginesCount * kChannelsCount][kHistoryPagesCount * kHistoryPageLength];
 
 class Buffers {
 public:
@@ -60,67 +125,61 @@ public:
         return _srcBufs[_providedSourceBufCount++];
     };
 
-    float* sliceBuffer() {
-        assert(_providedSliceBufCount < _slcBufsCount);
-        return _slcBufs[_providedSliceBufCount++];
+    float* slice_arena_buffer() {
+        assert(_provided_slice_arena_buf_count < _slice_arena_buf_count);
+        return _slice_arena_bufs[_provided_slice_arena_buf_count++];
     };
 
-    uint16_t* pitch_buf() {
-        assert(_provided_pitch_buf_count < _pitch_buf_count);
-        return _pitch_bufs[_provided_pitch_buf_count++];
+    LevelCell* level_buffer() {
+        assert(_provided_level_buf_count < _level_buf_count);
+        return _level_bufs[_provided_level_buf_count++];
     };
 
-private:
-    Buffers() {
-        auto srcbs = kSourceBufferLength * sizeof(float);
-        for (size_t i = 0; i < _srcBufsCount; i++) {
-            memset(_srcBufs[i], 0, srcbs);
-        }
-
-        auto slcbs = kSliceBufferLength * sizeof(float);
-        for (size_t i = 0; i < _slcBufsCount; i++) {
-            memset(_slcBufs[i], 0, slcbs);
-        }
+    float* history_buffer() {
+        assert(_provided_history_buf_count < _history_buf_count);
+        return _history_bufs[_provided_history_buf_count++];
     };
 
-    int _providedSourceBufCount { 0 };
-    static const int _srcBufsCount = kEnginesCount * kChannelsCount;
-    float* _srcBufs[_srcBufsCount] = {
-        _srcBuf1L,
-        _srcBuf1R,
-        _srcBuf2L,
-        _srcBuf2R
+    SlicePitchCell* slice_pitch_buf() {
+        assert(_provided_slc_pitch_buf_count < _slc_pitch_buf_count);
+        return _slc_pitch_bufs[_provided_slc_pitch_buf_count++];
     };
 
-    int _providedSliceBufCount { 0 };
-    static const int _slcBufsCount = kSlicesCount * kEnginesCount * kChannelsCount;
-    float* _slcBufs[_slcBufsCount] = {
-        _slcBuf1L,
-        _slcBuf1R,
-        _slcBuf2L,
-        _slcBuf2R,
-        _slcBuf3L,
-        _slcBuf3R,
-        _slcBuf4L,
-        _slcBuf4R,
-        _slcBuf5L,
-        _slcBuf5R,
-        _slcBuf6L,
-        _slcBuf6R
+    ContinualPitchCell* continual_pitch_buf() {
+        assert(_provided_ctn_pitch_buf_count < _ctn_pitch_buf_count);
+        return _ctn_pitch_bufs[_provided_ctn_pitch_buf_count++];
     };
 
-    int _provided_pitch_buf_count { 0 };
-    static const int _pitch_buf_count = (kSlicesCount + 1) * kEnginesCount;
-    uint16_t* _pitch_bufs[_pitch_buf_count] = {
-        _pitch_buf_1,
-        _pitch_buf_2,
-        _pitch_buf_3,
-        _pitch_buf_4,
-        _pitch_buf_5,
-        _pitch_buf_6,
-        _pitch_buf_7,
-        _pitch_buf_8
+    uint16_t* reverb_buffer() {
+        assert(!_is_reverb_buf_provided);
+        _is_reverb_buf_provided = true;
+        return _reverb_buf;
     };
+
+private:
+    //SDRAM isn't zeroed here. Sources clear their buffers lazily
+    //and slices never read past what they've written.
+    Buffers() = default;
+
+    int _providedSourceBufCount { 0 };
+    static const int _srcBufsCount = kEnginesCount * kSourceSlots * kChannelsCount;
+
+    int _provided_slice_arena_buf_count { 0 };
+    static const int _slice_arena_buf_count = kEnginesCount * kChannelsCount;
+
+    int _provided_level_buf_count { 0 };
+    static const int _level_buf_count = kEnginesCount * kSourceSlots;
+
+    int _provided_history_buf_count { 0 };
+    static const int _history_buf_count = kEnginesCount * kChannelsCount;
+
+    int _provided_slc_pitch_buf_count { 0 };
+    static const int _slc_pitch_buf_count = kSlicesCount * kEnginesCount;
+
+    int _provided_ctn_pitch_buf_count { 0 };
+    static const int _ctn_pitch_buf_count = kEnginesCount;
+
+    bool _is_reverb_buf_provided { false };
 };
 
 }
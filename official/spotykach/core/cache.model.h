@@ -0,0 +1,90 @@
+#pragma once
+
+#include <array>
+#include <stddef.h>
+#include <stdint.h>
+#include "access.trace.h"
+
+namespace blptls {
+namespace spotykach {
+
+/*
+Per component counters, write_backs are the dirty lines
+a component's miss pushed out, whoever dirtied them.
+*/
+struct CacheStats {
+    uint64_t accesses;
+    uint64_t misses;
+    uint64_t write_backs;
+
+    float miss_rate() const { return accesses > 0 ? static_cast<float>(misses) / accesses : 0.f; }
+};
+
+/*
+Set associative write-back data cache with LRU replacement, for
+replaying SPOTYKACH_ACCESS_TRACE traces on the host. The defaults are
+the Cortex-M7 D-cache of the Daisy Seed: 16 KB, 32 byte lines, 4 ways.
+Write misses allocate a line like the SDRAM region's default policy,
+kWriteAllocate = false models a write-through-no-allocate region instead.
+An access crossing a line boundary counts once per line.
+*/
+template<size_t kSize = 16384, size_t kLine = 32, size_t kWays = 4, bool kWriteAllocate = true>
+class CacheModel {
+public:
+    static constexpr size_t kSets = kSize / (kLine * kWays);
+    static_assert(kSets > 0 && (kSets & (kSets - 1)) == 0, "Set count has to be a power of 2");
+    static_assert((kLine & (kLine - 1)) == 0, "Line size has to be a power of 2");
+
+    void access(AccessComponent component, const void* address, size_t bytes, bool write) {
+        auto& stats = _stats[static_cast<size_t>(component)];
+        auto first = reinterpret_cast<uintptr_t>(address) / kLine;
+        auto last = (reinterpret_cast<uintptr_t>(address) + (bytes > 0 ? bytes - 1 : 0)) / kLine;
+        for (auto line = first; line <= last; line++) {
+            stats.accesses++;
+            if (!touch(line, write, stats)) stats.misses++;
+        }
+    }
+
+    const CacheStats& stats(AccessComponent component) const { return _stats[static_cast<size_t>(component)]; }
+
+    void reset() {
+        _sets = {};
+        _stats = {};
+        _clock = 0;
+    }
+
+private:
+    struct Way {
+        uintptr_t line;
+        uint64_t used;
+        bool valid;
+        bool dirty;
+    };
+
+    //Returns whether the line was cached.
+    bool touch(uintptr_t line, bool write, CacheStats& stats) {
+        auto& set = _sets[line & (kSets - 1)];
+        _clock++;
+        Way* victim = &set[0];
+        for (auto& way: set) {
+            if (way.valid && way.line == line) {
+                way.used = _clock;
+                way.dirty |= write;
+                return true;
+            }
+            if (!way.valid) victim = &way;
+            else if (victim->valid && way.used < victim->used) victim = &way;
+        }
+        if (write && !kWriteAllocate) return false;
+        if (victim->valid && victim->dirty) stats.write_backs++;
+        *victim = { line, _clock, true, write };
+        return false;
+    }
+
+    std::array<std::array<Way, kWays>, kSets> _sets {};
+    std::array<CacheStats, static_cast<size_t>(AccessComponent::Count)> _stats {};
+    uint64_t _clock = 0;
+};
+
+}
+}
@@ -7,11 +7,13 @@
 
 #include "core.h"
 #include "envelope.h"
-#include "source.h"
+#include "source.bank.h"
 #include "generator.h"
 #include "trigger.h"
 #include "lfo.h"
+#include "buffers.h"
 #include "../common/fcomp.h"
+#include <algorithm>
 
 using namespace blptls;
 using namespace spotykach;
@@ -21,7 +23,7 @@ Core::Core() {
     _releasePool.emplace_back(l);
 
     auto e_a = std::make_shared<Envelope>();
-    auto s_a = std::make_shared<Source>();
+    auto s_a = std::make_shared<SourceBank>();
     auto g_a = std::make_shared<Generator>(*s_a, *e_a, *l);
     auto t_a = std::make_shared<Trigger>(*g_a);
     _engines[0] = std::make_shared<Engine>(*t_a, *s_a, *e_a, *g_a, *l);
@@ -33,7 +35,7 @@ Core::Core() {
     t_a->index = 1;
 
     auto e_b = std::make_shared<Envelope>();
-    auto s_b = std::make_shared<Source>();
+    auto s_b = std::make_shared<SourceBank>();
     auto g_b = std::make_shared<Generator>(*s_b, *e_b, *l);
     auto t_b = std::make_shared<Trigger>(*g_b);
     _engines[1] = std::make_shared<Engine>(*t_b, *s_b, *e_b, *g_b, *l);
@@ -76,16 +78,16 @@ void Core::setMutex(bool mutex) {
 void Core::setVolumeBalance(float value) {
     float amp = 1.7;
     if (fcomp(value, 0.5)) {
-        _vol[0] = amp;
-        _vol[1] = amp;
+        _vol[0].set(amp);
+        _vol[1].set(amp);
     }
     else if (value < 0.5) {
-        _vol[0] = amp;
-        _vol[1] = logVolume(2 * value) * amp;    
+        _vol[0].set(amp);
+        _vol[1].set(logVolume(2 * value) * amp);
     } 
     else {
-        _vol[0] = logVolume(2 * (1 - value)) * amp;
-        _vol[1] = amp;
+        _vol[0].set(logVolume(2 * (1 - value)) * amp);
+        _vol[1].set(amp);
     }
 }
 
@@ -151,17 +153,26 @@ void Core::setSplit(bool value) {
     _split = value;
 }
 
-void Core::initialize() const {
+void Core::initialize() {
     for (auto e: _engines) e->initialize();
+    _reverb.initialize(Buffers::pool().reverb_buffer());
 }
 
+/*
+Engine B is held back on the ticks engine A triggers on. Triggers look
+a tick ahead, so A's lock is for the tick after the current one, except
+after a reset, when the current tick is looked at first: both are primed
+first, so B's look at the current tick sees A's lock for it.
+*/
 void Core::tick() {
-    auto& e1 = engineAt(0);
-    e1.trig().next(true);
-    
-    auto& e2 = engineAt(1);
-    bool engaged = !(_mutex && e1.trig().is_locking());
-    e2.trig().next(engaged);
+    auto& t1 = engineAt(0).trig();
+    auto& t2 = engineAt(1).trig();
+    t1.prime(true);
+    t2.prime(!(_mutex && t1.is_locking()));
+
+    t1.next(true);
+    bool engaged = !(_mutex && t1.is_locking());
+    t2.next(engaged);
 }
 
 void Core::set_playback_controls(PlaybackControls c) {
@@ -172,11 +183,26 @@ void Core::preprocess(PlaybackParameters p) const {
     for (auto& e: _engines) e->preprocess(p);
 }
 
-void Core::process(const float* const* in_buf, float** out_buf, int num_frames) const {
+bool Core::idle() const {
+    auto is_busy = false;
+    for (auto& e: _engines) is_busy |= e->idle();
+    return is_busy;
+}
+
+void Core::process(const float* const* in_buf, float** out_buf, int num_frames) {
     auto& e1 = engineAt(0);
     auto& e2 = engineAt(1);
-    auto e1_vol = _vol[0];
-    auto e2_vol = _vol[1];
+    for (auto& v: _vol) v.begin_block(num_frames);
+
+    auto e1_on = e1.begin_block(num_frames, _p_ctrls.ctns_a);
+    auto e2_on = e2.begin_block(num_frames, _p_ctrls.ctns_b);
+    if (!e1_on && !e2_on) {
+        std::fill(out_buf[0], out_buf[0] + num_frames, 0.f);
+        std::fill(out_buf[1], out_buf[1] + num_frames, 0.f);
+        //The reverb tail and the limiter delay still have to drain.
+        post_process(out_buf, num_frames);
+        return;
+    }
 
     for (int f = 0; f < num_frames; f++) {
         float in_0_ext = in_buf[0][f];
@@ -184,14 +210,16 @@ void Core::process(const float* const* in_buf, float** out_buf, int num_frames)
 
         float out_0_a = 0;
         float out_1_a = 0;
-        e1.process(in_0_ext, in_1_ext, &out_0_a, &out_1_a, _p_ctrls.ctns_a, _p_ctrls.rev_a);
+        if (e1_on) e1.process(in_0_ext, in_1_ext, &out_0_a, &out_1_a, _p_ctrls.ctns_a, _p_ctrls.rev_a);
 
         float out_0_b = 0;
         float out_1_b = 0;
         float e2_in0 = _cascade ? out_0_a : in_0_ext;
         float e2_in1 = _cascade ? out_0_a : in_1_ext;
-        e2.process(e2_in0, e2_in1, &out_0_b, &out_1_b, _p_ctrls.ctns_b, _p_ctrls.rev_b);
+        if (e2_on) e2.process(e2_in0, e2_in1, &out_0_b, &out_1_b, _p_ctrls.ctns_b, _p_ctrls.rev_b);
 
+        auto e1_vol = _vol[0].next();
+        auto e2_vol = _vol[1].next();
         out_0_a *= e1_vol;
         out_1_a *= e1_vol;
 
@@ -207,4 +235,12 @@ void Core::process(const float* const* in_buf, float** out_buf, int num_frames)
             out_buf[1][f] = out_0_a + out_0_b;
         }
     }
+
+    post_process(out_buf, num_frames);
+}
+
+void Core::post_process(float** out_buf, int num_frames) {
+    _reverb.set_amount(_split ? 0.f : _reverb_amount);
+    _reverb.process(out_buf[0], out_buf[1], num_frames);
+    _limiter.process(out_buf[0], out_buf[1], num_frames);
 }
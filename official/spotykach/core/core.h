@@ -5,6 +5,9 @@
 #include <memory>
 #include "engine.h"
 #include "globals.h"
+#include "ramp.h"
+#include "../fx/limiter.h"
+#include "../fx/reverb.h"
 #include "../control/clockable.h"
 
 namespace blptls {
@@ -41,19 +44,31 @@ public:
 
     void set_playback_controls(PlaybackControls c);
 
-    void initialize() const;
+    //Post mix diffuser and reverb dry/wet, off in split mode.
+    void set_reverb_amount(float value) { _reverb_amount = value; }
+
+    void initialize();
     void preprocess(PlaybackParameters p) const;
-    void process(const float* const* inBuf, float** outBuf, int numFrames) const;
+    void process(const float* const* inBuf, float** outBuf, int numFrames);
+    //Main loop work, returns true while there's more of it to do right away.
+    bool idle() const;
+
+    const LimiterStats& limiter_stats() const { return _limiter.stats(); }
     
 private:
+    void post_process(float** outBuf, int numFrames);
+
     std::array<std::shared_ptr<Engine>, kEnginesCount> _engines;
     
-    float _vol[kEnginesCount];
+    Ramp _vol[kEnginesCount];
     float pattern_balance_;
     bool _split;
     bool _mutex;
     bool _cascade;
     PlaybackControls _p_ctrls;
+    Reverb _reverb;
+    float _reverb_amount { 0 };
+    Limiter _limiter;
     std::vector<std::shared_ptr<void>> _releasePool;
 };
 }
@@ -26,7 +26,8 @@ Engine::Engine(ITrigger& t, ISource& s, IEnvelope& e, IGenerator& g, ILFO& l):
     _is_playing { false },
     _tempo      { 0 },
     _step       { 0 },
-    _invalidate_crossfade { false }
+    _invalidate_crossfade { false },
+    _activity   { 0, 0, 0 }
 {
     _trigger.on_pattern_changed([this](uint32_t step){ 
         this->_step = step;
@@ -77,12 +78,16 @@ void Engine::set_reverse(bool value) {
 
 void Engine::set_frozen(bool frozen) {
     auto isTurningOff = _raw.frozen && !frozen;
+    auto isTurningOn = !_raw.frozen && frozen;
     _raw.frozen = frozen;
+    //The take starts where it's recorded, the source gets it ready there.
+    if (isTurningOff) _generator.set_cycle_start();
     _source.set_frozen(frozen);
     if (isTurningOff) {
-        _generator.set_cycle_start();
+        _onsets.begin();
         _generator.set_needs_reset_slices();
     }
+    if (isTurningOn) _onsets.end();
 }
 
 void Engine::set_antifreeze(bool value) {
@@ -116,14 +121,38 @@ void Engine::preprocess(PlaybackParameters p) {
     if (_invalidate_crossfade) {
         uint32_t framesPerStep { static_cast<uint32_t>(static_cast<float>(_step) * framesPerMeasure / (kPPQN * kBeatsPerMeasure)) };
         uint32_t framesPerSlice { _generator.frames_per_slice() };
-        _envelope.setFramesPerCrossfade(std::max(framesPerSlice - framesPerStep, uint32_t(0)));
+        auto framesPerCrossfade = static_cast<int32_t>(framesPerSlice) - static_cast<int32_t>(framesPerStep);
+        _envelope.setFramesPerCrossfade(std::max(framesPerCrossfade, int32_t(0)));
         _invalidate_crossfade = false;
     }
 }
 
+/*
+Called once per audio block. An engine that is frozen, has no slices
+playing and isn't in continual mode would only write nothing and sum zeros,
+so it returns false and process() isn't called for the block.
+Slices are activated on clock ticks, which come before the block,
+so none can start in the middle of a skipped block.
+*/
+bool Engine::begin_block(size_t frames, bool continual) {
+    _activity.blocks++;
+    _generator.begin_block(frames);
+    auto slices = _generator.active_slices();
+    _activity.slice_blocks += slices;
+    if (continual || slices > 0 || _generator.is_spectral() || !_source.is_idle()) return true;
+    _activity.idle_blocks++;
+    if (_source.apply_selection()) _generator.set_needs_reset_slices();
+    //The LFO is shared and the slot crossfade runs with the recording,
+    //they keep running as if the frames were processed.
+    _jitterLFO.skip(frames);
+    _source.skip(frames);
+    return false;
+}
+
 void Engine::process(float in0, float in1, float* out0, float* out1, bool continual, bool reverse) {
     _jitterLFO.advance();
     _source.write(in0, in1);
+    if (!_raw.frozen) _onsets.write(in0, in1);
     _generator.generate(out0, out1, continual, reverse);
 }
 
@@ -133,6 +162,32 @@ void Engine::reset(bool hard) {
     _trigger.reset();
 }
 
+/*
+Non-realtime work, called from the main loop.
+Returns true while a take is being restored. Slices hold copies of
+the audio, once it's restored they are refilled on the next activation.
+*/
+bool Engine::idle() {
+    auto was_restoring = _source.is_restoring();
+    _source.sweep();
+    if (!was_restoring) return false;
+    if (_source.is_restoring()) return true;
+    _generator.set_needs_reset_slices();
+    return false;
+}
+
+void Engine::undo() {
+    _source.undo();
+}
+
+void Engine::redo() {
+    _source.redo();
+}
+
+void Engine::select_next_source() {
+    _source.select_slot((_source.selected_slot() + 1) % _source.slots_count());
+}
+
 void Engine::clear_buffer() {
     _source.reset();
     _generator.reset();
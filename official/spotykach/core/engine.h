@@ -5,6 +5,7 @@
 #include "i.envelope.h"
 #include "i.generator.h"
 #include "i.lfo.h"
+#include "onset.envelope.h"
 #include "globals.h"
 #include "../fx/pitch.shift.h"
 
@@ -16,6 +17,18 @@ struct PlaybackParameters {
     float sampleRate;
 };
 
+/*
+Audio blocks counters, read them with the debugger.
+slice_blocks - active slices summed over all blocks.
+*/
+struct EngineActivity {
+    uint32_t blocks;
+    uint32_t idle_blocks;
+    uint32_t slice_blocks;
+};
+
+using Onsets = OnsetEnvelope<kSourceBufferLength>;
+
 struct RawParameters {
     float slicePosition    = -1;
     float sliceLength      = -1;
@@ -57,10 +70,26 @@ public:
 
     void set_on_slice(SliceCallback f);
 
+    bool begin_block(size_t frames, bool continual);
     void process(float in0, float in1, float* out0, float* out1, bool continual, bool reverse);
 
+    const EngineActivity& activity() const { return _activity; }
+
+    //Onset strength of the last take, see TempoEstimator.
+    const Onsets& onsets() const { return _onsets; }
+
     void reset(bool hard);
     void clear_buffer();
+
+    bool idle();
+
+    void undo();
+    void redo();
+
+    void set_spectral(bool value) { _generator.set_spectral(value); }
+
+    //Cycles through the resident recordings, see SourceBank.
+    void select_next_source();
     
     int index = -1;
 
@@ -80,6 +109,9 @@ private:
     uint32_t _step;
 
     bool _invalidate_crossfade;
+
+    EngineActivity _activity;
+    Onsets _onsets;
 };
 }
 }
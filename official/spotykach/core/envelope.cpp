@@ -1,4 +1,7 @@
 #include "envelope.h"
+#include "globals.h"
+
+using namespace blptls::spotykach;
 
 static const float kP      = 3.1415926535898;
 static const float kP_2    = 1.5707963267949;
@@ -40,14 +43,23 @@ void Envelope::measure() {
         _attackLength = _decayLength = _framesPerCrossfade;
     }
     else {
-        _attackLength = _decayLength = _declick ? 512 : 0;
+        _attackLength = _decayLength = _declick ? kDeclickFrames : 0;
     }
 }
 
 float Envelope::attackAttenuation(long currentFrame) {
-    return _attackLength > 0 ? sine(kP_2 * currentFrame / _attackLength) : 1;
+    return attackAttenuation(currentFrame, _attackLength);
 }
 
 float Envelope::decayAttenuation(long currentFrame) {
-    return _decayLength > 0 ? sine(kP_2 + kP_2 * currentFrame / _decayLength) : 1;
+    return decayAttenuation(currentFrame, _decayLength);
+}
+
+float Envelope::attackAttenuation(long currentFrame, long length) {
+    return length > 0 ? sine(kP_2 * currentFrame / length) : 1;
+}
+
+//Mirrored into the first quarter, the polynomial is off by 7% near pi.
+float Envelope::decayAttenuation(long currentFrame, long length) {
+    return length > 0 ? sine(kP_2 - kP_2 * currentFrame / length) : 1;
 }
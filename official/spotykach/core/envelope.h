@@ -17,6 +17,9 @@ public:
     float attackAttenuation(long currentFrame) override;
     float decayAttenuation(long currentFrame) override;
 
+    float attackAttenuation(long currentFrame, long length) override;
+    float decayAttenuation(long currentFrame, long length) override;
+
 private:
     bool _declick;
     long _attackLength;
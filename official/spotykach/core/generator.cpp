@@ -19,19 +19,26 @@ Modulations modulations(float x) {
     if (x < 0.33)  return { 2.27f * x, 0 };
     if (x < 0.66)  return { 1.5f - 2.27f * x, 2.f * (x - 0.33f) };
     if (x < 1.0)   return { 0, 1.32f - 2.f * (x - 0.33f) };
-};
+    return { 0, 0 };
+}
 
 Generator::Generator(ISource& in_source, IEnvelope& in_envelope, ILFO& in_jitter_lfo) :
     _source             { in_source },
     _envelope           { in_envelope },
     _jitter_lfo         { in_jitter_lfo },
+    _jump_from          { 0 },
+    _jump_left          { 0 },
+    _slice_position     { -1 },
     _raw_onset          { 0 },
     _reverse            { false },
-    _slice_position     { -1 },
+    _prepared           { nullptr },
+    _prepared_length    { 0 },
+    _prepared_reverse   { false },
     _continual          { false },
     _continual_rev      { false },
     _continual_iterator { 0 } {
     for (auto i = 0; i < kSlicesCount; i++) {
+        _buffers[i].attach(_arena, i);
         _slices[i] = std::make_shared<Slice>(_source, _buffers[i] ,_envelope);
     }
     reset();
@@ -39,14 +46,16 @@ Generator::Generator(ISource& in_source, IEnvelope& in_envelope, ILFO& in_jitter
 
 void Generator::set_pitch_shift(float value) {
     _pitch_shift = value;
-    _continual_pitch.setShift(value);
+    _continual_pitch.rampShift(value);
 }
 
 void Generator::set_slice_position(float value) {
     auto init_sycle_start = _slice_position < 0;
     _slice_position = value;
     _slice_position_frames = _source.length() * _slice_position;
+    _position.set(_slice_position_frames);
     if (init_sycle_start) set_cycle_start();
+    if (_spectral.is_enabled()) _spectral.capture(_slice_position_frames);
 }
 
 void Generator::set_jitter_amount(float value) {
@@ -69,8 +78,10 @@ void Generator::set_cycle_start() {
 }
 
 void Generator::initialize() {
+    _arena.initialize();
     for (auto s: _slices) s->initialize();
-    _continual_pitch.initialize(kSampleRate, 4096);
+    _continual_pitch.initialize(Buffers::pool().continual_pitch_buf());
+    _spectral.initialize();
 }
 
 void Generator::set_frames_per_measure(uint32_t value) {
@@ -91,13 +102,30 @@ void Generator::generate(float* out0, float* out1, bool continual, bool reverse)
         out_1_val += slice_out_1;
     }
 
+    if (_spectral.is_active()) {
+        auto value = _spectral.process(_source);
+        out_0_val += value;
+        out_1_val += value;
+    }
+
     if (continual) {
         if (!_continual) {
             _continual_iterator = 0;
             _continual = true;
+            _position.jump(_slice_position_frames);
         }
-        auto frame = _source.is_frozen() ? _slice_position_frames + _continual_iterator : _source.read_head();
+        auto position = static_cast<size_t>(_position.next());
+        auto frame = _source.is_frozen() ? position + _continual_iterator : _source.read_head();
         _source.read(slice_out_0, slice_out_1, frame);
+        if (_jump_left > 0) {
+            float from_0, from_1;
+            _source.read(from_0, from_1, _jump_from + _continual_iterator);
+            auto n = kDeclickFrames - _jump_left--;
+            auto in = _envelope.attackAttenuation(n, kDeclickFrames);
+            auto out = _envelope.decayAttenuation(n, kDeclickFrames);
+            slice_out_0 = slice_out_0 * in + from_0 * out;
+            slice_out_1 = slice_out_1 * in + from_1 * out;
+        }
         _continual_pitch.process(&slice_out_0, &slice_out_1);
         out_0_val += slice_out_0;
         out_1_val += slice_out_1;
@@ -113,24 +141,68 @@ void Generator::generate(float* out0, float* out1, bool continual, bool reverse)
             _continual_iterator ++;
         }
     }
+    else {
+        _jump_left = 0;
+    }
 
     *out0 = out_0_val;
     *out1 = out_1_val;
 }
 
+//Replaces slices with the resynthesized spectrum at the slice position.
+void Generator::set_spectral(bool value) {
+    if (value == _spectral.is_enabled()) return;
+    if (value) _spectral.capture(_slice_position_frames);
+    _spectral.set_enabled(value);
+}
+
+/*
+A glide over a long move would scrub through the source. Those jump,
+playback fades out where it was while it fades in at the target, equal power
+along the envelope's quarter sines. The next jump waits for the fade.
+*/
+void Generator::begin_block(size_t frames) {
+    auto from = _position.value();
+    auto distance = fabsf(_position.target() - from);
+    if (_continual && _source.is_frozen() && _jump_left == 0 && distance > kPositionGlideFrames) {
+        _jump_from = static_cast<size_t>(from);
+        _jump_left = kDeclickFrames;
+        _position.jump(_position.target());
+    }
+    _position.begin_block(frames);
+    _continual_pitch.begin_block(frames);
+}
+
+uint32_t Generator::active_slices() {
+    uint32_t count = 0;
+    for (auto& s: _slices) count += s->isActive();
+    return count;
+}
+
 void Generator::set_on_slice(SliceCallback f) {
     _on_slice = f;
 }
 
-void Generator::activate_slice(float in_raw_onset, int direction) {
+/*
+Everything but the start: the offset, jitter, pitch and the arena room
+are worked out a tick before the slice is due, see Trigger::next().
+A prepared slice that wasn't started is dropped by the next one.
+*/
+void Generator::prepare_slice(float in_raw_onset, int direction) {
+    if (_prepared) {
+        _prepared->cancel();
+        _prepared = nullptr;
+    }
+    if (_source.apply_selection()) set_needs_reset_slices();
+    if (_spectral.is_enabled()) return;
     auto reset = !fcomp(in_raw_onset, _raw_onset) || !_source.is_frozen();
     auto offset = _slice_position_frames;
     auto lfo_value = _jitter_lfo.triangleValue();
     auto m = modulations(_jitter_amount);
     if (m.position > 0.05) {
         auto length = _source.length() - 1;
-        offset += lfo_value * m.position * length;
-        offset = std::min(std::max(offset, 0u), length);
+        auto position = offset + lfo_value * m.position * length;
+        offset = static_cast<size_t>(std::min(std::max(position, 0.f), static_cast<float>(length)));
         reset = true;
     }
     auto pitch_shift = _pitch_shift;
@@ -156,14 +228,67 @@ void Generator::activate_slice(float in_raw_onset, int direction) {
     }
     
     auto onset = _frames_per_beat * _raw_onset;
-    auto slice_start = onset + offset;
+    size_t slice_start = onset + offset;
+    if (!reverse) slice_start = snap_to_onset(slice_start);
+
+    //Nothing to play in a silent part of the recorded loop.
+    if (_source.is_frozen() && _source.level(slice_start, slice_start + frames_per_slice).peak() < kSilenceLevel) return;
+
+    auto aligned = align_to_zero_crossings(slice_start, frames_per_slice);
     
+    //With all of them playing, the one furthest in is retriggered.
+    Slice* slice = nullptr;
     for (auto& s: _slices) {
-        if (s->isActive()) continue;
-        s->activate(slice_start, frames_per_slice, reverse, pitch_shift, volume);
-        if (_on_slice) _on_slice(frames_per_slice, reverse);
-        break;
+        if (s->isInactive()) {
+            slice = s.get();
+            break;
+        }
+        if (!slice || s->position() > slice->position()) slice = s.get();
     }
+    slice->prepare(slice_start, frames_per_slice, reverse, pitch_shift, volume, aligned);
+    _prepared = slice;
+    _prepared_length = frames_per_slice;
+    _prepared_reverse = reverse;
+}
+
+void Generator::start_slice() {
+    if (!_prepared) return;
+    _prepared->start();
+    if (_on_slice) _on_slice(_prepared_length, _prepared_reverse);
+    _prepared = nullptr;
+}
+
+/*
+Moves the slice start to the closest detected onset
+so the slice doesn't start in the middle of a transient.
+*/
+size_t Generator::snap_to_onset(size_t frame) {
+    auto wrapped = frame % _source.length();
+    auto onset = _source.nearest_onset(wrapped, kOnsetSnapFrames);
+    if (onset == SIZE_MAX) return frame;
+    return frame - wrapped + onset;
+}
+
+/*
+Nudges both slice boundaries to the closest zero crossings.
+Returns true if both were found within the tolerance.
+*/
+bool Generator::align_to_zero_crossings(size_t& start, size_t& length) {
+    auto length_s = _source.length();
+    auto wrapped = start % length_s;
+    auto start_crossing = _source.nearest_zero_crossing(wrapped, kZeroCrossTolerance);
+    if (start_crossing == SIZE_MAX) return false;
+    auto aligned_start = start - wrapped + start_crossing;
+
+    auto end = (aligned_start + length) % length_s;
+    auto end_crossing = _source.nearest_zero_crossing(end, kZeroCrossTolerance);
+    if (end_crossing == SIZE_MAX) return false;
+    int32_t delta = static_cast<int32_t>(end_crossing) - static_cast<int32_t>(end);
+    auto aligned_length = static_cast<int32_t>(length) + delta;
+    if (aligned_length <= 0 || aligned_length > static_cast<int32_t>(kSliceBufferLength)) return false;
+    start = aligned_start;
+    length = aligned_length;
+    return true;
 }
 
 void Generator::reset() {
@@ -7,6 +7,8 @@
 #include "slice.h"
 #include "globals.h"
 #include "slice.buffer.h"
+#include "../fx/spectral.freeze.h"
+#include "ramp.h"
 #include "globals.h"
 #include <array>
 #include <memory>
@@ -31,8 +33,13 @@ public:
     
     void set_on_update(std::function<void()> on_update);
 
-    void activate_slice(float, int) override;
+    void prepare_slice(float, int) override;
+    void start_slice() override;
     void generate(float*, float*, bool, bool) override;
+    uint32_t active_slices() override;
+    void begin_block(size_t frames) override;
+    void set_spectral(bool) override;
+    bool is_spectral() override { return _spectral.is_active(); }
     void reset() override;
 
     void set_on_slice(SliceCallback) override;
@@ -44,11 +51,21 @@ public:
     void set_needs_reset_slices() override;
 
 private:
+    size_t snap_to_onset(size_t frame);
+    bool align_to_zero_crossings(size_t& start, size_t& length);
+
     ISource& _source;
     IEnvelope& _envelope;
     ILFO& _jitter_lfo;
-    PitchShift _continual_pitch;
+    ContinualPitchShift _continual_pitch;
+    SpectralFreeze<kSpectralSize> _spectral;
+    //Continual playback position in frames, the slices start at _slice_position_frames.
+    Ramp _position;
+    //Where continual playback was before a jump, faded out over kDeclickFrames.
+    size_t _jump_from;
+    size_t _jump_left;
     std::array<std::shared_ptr<Slice>, kSlicesCount> _slices;
+    SliceArena _arena;
     std::array<SliceBuffer, kSlicesCount> _buffers;
 
     std::function<void()> _on_update;
@@ -65,6 +82,9 @@ private:
     bool _reverse;
 
     SliceCallback _on_slice;
+    Slice* _prepared;
+    uint32_t _prepared_length;
+    bool _prepared_reverse;
 
     bool _continual;
     bool _continual_rev;
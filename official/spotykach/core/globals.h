@@ -1,19 +1,84 @@
 #pragma once
 
 #include <array>
+#include <stdint.h>
 #include <math.h>
 
+#ifndef SPOTYKACH_SAMPLE_RATE
+#define SPOTYKACH_SAMPLE_RATE 48000
+#endif
+#ifndef SPOTYKACH_BLOCK_SIZE
+#define SPOTYKACH_BLOCK_SIZE 4
+#endif
+
 namespace blptls {
 namespace spotykach {
+    /*
+    Audio configuration. Everything depending on the sample rate,
+    the block size or the clock resolution is derived from here at compile time,
+    e.g. C_DEFS += -DSPOTYKACH_SAMPLE_RATE=96000 -DSPOTYKACH_BLOCK_SIZE=16
+    */
+    template <uint32_t kRate, uint32_t kBlock, uint32_t kTicksPerQuarter = 96>
+    struct AudioPolicy {
+        static_assert(kRate == 8000 || kRate == 16000 || kRate == 32000 || kRate == 48000 || kRate == 96000, "Unsupported sample rate");
+        static_assert(kBlock > 0, "Empty audio block");
+
+        static constexpr uint32_t sample_rate   { kRate };
+        static constexpr uint32_t block_size    { kBlock };
+        static constexpr uint32_t ppqn          { kTicksPerQuarter };
+        //Audio callback period, microseconds
+        static constexpr uint32_t block_mks     { static_cast<uint32_t>(1000000ull * kBlock / kRate) };
+    };
+
+    using Policy = AudioPolicy<SPOTYKACH_SAMPLE_RATE, SPOTYKACH_BLOCK_SIZE>;
+
     static const uint32_t kEnginesCount     { 2 };
 
     static const uint32_t kSlicesCount      { 3 };
     static const uint32_t kSliceMaxSeconds  { 2 };
+    //Slice audio memory per engine, slices take as much of it as they are long.
+    static const uint32_t kSliceArenaSeconds { 4 };
     static const uint32_t kSourceMaxSeconds { 10 };
 
+    //Takes that can be undone and the undo memory per engine, in source lengths.
+    static const uint32_t kUndoDepth        { 4 };
+    static const uint32_t kUndoSources      { 2 };
+
     static const uint32_t kChannelsCount    { 2 };
-    static const uint32_t kSampleRate       { 48000 };
-    static const uint32_t kBufferSize       { 4 };
+    static constexpr uint32_t kSampleRate   { Policy::sample_rate };
+    static constexpr uint32_t kBufferSize   { Policy::block_size };
+
+    //Frame counts tuned at 48 kHz, scaled to keep their duration.
+    static constexpr uint32_t frames_at_48k(uint32_t frames) {
+        return static_cast<uint32_t>(static_cast<uint64_t>(frames) * kSampleRate / 48000);
+    }
+
+    static constexpr uint32_t kOnsetSnapFrames  { frames_at_48k(1024) };
+    static constexpr float kSilenceLevel        { 1e-3f };
+
+    static constexpr uint32_t kDeclickFrames        { frames_at_48k(512) };
+    static constexpr uint32_t kAlignedDeclickFrames { frames_at_48k(32) };
+    static constexpr uint32_t kZeroCrossTolerance   { frames_at_48k(64) };
+    static constexpr uint32_t kSourceSwitchFrames   { frames_at_48k(480) };
+    //Glide of knob driven parameters, about a controller period, see Ramp.
+    static constexpr uint32_t kParameterRampFrames  { frames_at_48k(96) };
+    //Continual playback position moves up to this glide, longer ones jump with a declick.
+    static constexpr uint32_t kPositionGlideFrames  { 4 * kBufferSize };
+
+    //Spectral freeze FFT size, the hop is a quarter of it.
+    static constexpr size_t kSpectralSize { 1024 };
+
+    //Reverb delay memory in 16-bit cells, a power of two, see fx/reverb.h
+    static constexpr size_t kReverbMemorySize { kSampleRate > 48000 ? 131072 : 65536 };
+
+    //Stream recorder ring in SDRAM, 32-bit stereo frames, see control/stream.recorder.h
+    static constexpr uint32_t kRecorderRingFrames { 1 << 16 };
+
+    static constexpr size_t kSourceBufferLength = kSourceMaxSeconds * kSampleRate;
+    static constexpr size_t kSliceBufferLength = kSliceMaxSeconds * kSampleRate;
+    //Room for two slices at the longest length, a slice that finds none plays from the source.
+    static constexpr size_t kSliceArenaLength = kSliceArenaSeconds * kSampleRate;
+    static_assert(kSliceArenaLength >= kSliceBufferLength, "The slice arena should fit the longest slice");
 
     static const float kSecondsPerMinute    { 60.0 };
 
@@ -34,7 +99,7 @@ namespace spotykach {
     };
 
     static const uint32_t kBeatsPerMeasure  { 4 };
-    static const uint32_t kPPQN             { 96 };
+    static constexpr uint32_t kPPQN         { Policy::ppqn };
 
     using Step = int;
     static constexpr std::array<Step, 11> EvenSteps {{
@@ -67,7 +132,7 @@ namespace spotykach {
     static constexpr int EvenStepsCount = EvenSteps.size();
     static constexpr int CWordsCount = CWords.size();
 
-    static const float kTempoMin = 30;
-    static const float kTempoMax = 250;
+    static constexpr float kTempoMin = 30;
+    static constexpr float kTempoMax = 250;
 }
 }
@@ -9,6 +9,9 @@ public:
     
     virtual float attackAttenuation(long currentFrame) = 0;
     virtual float decayAttenuation(long currentFrame) = 0;
+
+    virtual float attackAttenuation(long currentFrame, long length) = 0;
+    virtual float decayAttenuation(long currentFrame, long length) = 0;
     
     virtual ~IEnvelope() {};
 };
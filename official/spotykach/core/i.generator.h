@@ -3,6 +3,7 @@
 #include "globals.h"
 #include "i.envelope.h"
 #include <stdint.h>
+#include <functional>
 #include <algorithm>
 
 using SliceCallback = std::function<void(uint32_t, bool)>;
@@ -17,8 +18,16 @@ public:
     virtual void set_slice_length(float) = 0;
     virtual uint32_t frames_per_slice() = 0;
     virtual void set_reverse(bool value) = 0;
-    virtual void activate_slice(float onset, int direction) = 0;
+    //Works out a slice ahead of its tick, start_slice() only turns it on.
+    virtual void prepare_slice(float onset, int direction) = 0;
+    virtual void start_slice() = 0;
     virtual void generate(float* out0, float* out1, bool continual, bool reverse) = 0;
+    virtual uint32_t active_slices() = 0;
+    //Advances the parameter ramps, once per audio block.
+    virtual void begin_block(size_t frames) = 0;
+    virtual void set_spectral(bool value) = 0;
+    //Spectral freeze is on or still fading out.
+    virtual bool is_spectral() = 0;
     virtual void set_needs_reset_slices() = 0;
     virtual void set_cycle_start() = 0;
     virtual void set_on_slice(SliceCallback f) = 0;
@@ -6,4 +6,5 @@ public:
     virtual void setFramesPerMeasure(long frames) = 0;
     virtual float triangleValue() = 0;
     virtual void advance() = 0;
+    virtual void skip(long frames) = 0;
 };
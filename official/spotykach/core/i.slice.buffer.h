@@ -1,5 +1,8 @@
 #pragma once
 
+#include <stddef.h>
+#include <stdint.h>
+
 class ISliceBuffer {
 public:
     virtual void initialize() = 0;
@@ -12,6 +15,12 @@ public:
     virtual bool isFull() = 0;
     
     virtual void reset() = 0;
+
+    //Room for the given frames, false if there's none.
+    virtual bool allocate(size_t frames) = 0;
+    //Keeps the frames written before, false if they are gone.
+    virtual bool retain() = 0;
+    virtual void release() = 0;
     
     virtual ~ISliceBuffer() {};
 };
@@ -1,6 +1,15 @@
 #pragma once
 
 #include <stdint.h>
+#include <stddef.h>
+
+struct SignalLevel {
+    float min;
+    float max;
+    float rms;
+
+    float peak() const { return max > -min ? max : -min; }
+};
 
 class ISource {
 public:
@@ -17,9 +26,33 @@ public:
     virtual void initialize() = 0;
     
     virtual void write(float in0, float in1) = 0;
+    //Frozen and faded out, write() has nothing to do.
+    virtual bool is_idle() = 0;
 
     virtual size_t read_head() = 0;
     virtual void read(float& out0, float& out1, size_t frameIndex) = 0;
+
+    virtual size_t nearest_onset(size_t frame, size_t tolerance) = 0;
+
+    virtual SignalLevel level(size_t from, size_t to) = 0;
+
+    virtual size_t nearest_zero_crossing(size_t frame, size_t tolerance) = 0;
     
     virtual void reset() = 0;
+    virtual void sweep() = 0;
+
+    //Take undo / redo, only while idle. Return false if there's nothing to do.
+    virtual bool undo() = 0;
+    virtual bool redo() = 0;
+    //The take is restored by sweep(), recording waits for it.
+    virtual bool is_restoring() = 0;
+
+    //Resident recordings, a plain source has a single one.
+    virtual size_t slots_count() { return 1; }
+    virtual size_t selected_slot() { return 0; }
+    virtual void select_slot(size_t) {}
+    //Switches to the selected slot, returns true if it did.
+    virtual bool apply_selection() { return false; }
+    //Frames that pass while the engine is idle and write() isn't called.
+    virtual void skip(size_t) {}
 };
@@ -16,9 +16,6 @@ public:
     virtual uint32_t next_pattern() = 0;
     virtual uint32_t prev_pattern() = 0;
 
-    virtual void prepare_meter_pattern(uint32_t step, uint32_t shift) = 0;
-    virtual void prepare_cword_pattern(uint32_t onsets, uint32_t shift) = 0;
-
     virtual void on_pattern_changed(std::function<void(uint32_t)> on_changed) = 0;
 
     virtual Grid grid() = 0;
@@ -27,10 +24,16 @@ public:
     virtual void set_repeats(float repeats) = 0;
     virtual void set_retrigger(float retrigger) = 0;
 
+    //Looks at the current tick after a reset, next() does it otherwise.
+    virtual void prime(bool engaged) = 0;
     virtual void next(bool engaged) = 0;
 
     virtual bool is_locking() = 0;
 
+    //Ticks from the pattern start to the tick that comes next.
+    virtual uint32_t pattern_position() = 0;
+    virtual uint32_t pattern_ticks() = 0;
+
     virtual void reset() = 0;
 
     virtual ~ITrigger() {};
@@ -36,6 +36,10 @@ void LFO::advance() {
     _frame = (_frame + 1) % _framesPerMeasure;
 }
 
+void LFO::skip(long frames) {
+    _frame = (_frame + frames) % _framesPerMeasure;
+}
+
 float LFO::triangleValue() {
     long fp = _framesPerMeasure * _period / 2;
     return (2.0 / fp) * (fp - std::abs(mod(_frame - fp, 2 * fp) - fp)) - 1.0;
@@ -9,6 +9,7 @@ public:
     void setPeriod(float) override;
     void setFramesPerMeasure(long) override;
     void advance() override;
+    void skip(long frames) override;
     float triangleValue() override;
     
 private:
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <math.h>
+#include "globals.h"
+
+namespace blptls {
+namespace spotykach {
+
+/*
+Onset strength of the last take, one value per hop of kHop frames:
+the rise of the RMS over the previous hop, falls are dropped.
+The RMS rather than the log energy keeps accents stronger
+than the quiet subdivisions between them.
+The audio callback writes it while recording, the tempo estimator
+reads it from the main loop once the take is over.
+A ring of kHops values covers the longest take, older hops are overwritten.
+*/
+template <size_t kLength>
+class OnsetEnvelope {
+public:
+    static constexpr size_t kHop = frames_at_48k(256);
+    static constexpr size_t kHops = (kLength + kHop - 1) / kHop;
+    static constexpr float kHopsPerSecond = static_cast<float>(kSampleRate) / kHop;
+
+    //Main loop side, recording starts and stops.
+    void begin() {
+        _count = 0;
+        _frame = 0;
+        _energy = 0;
+        _rms = 0;
+        _is_recording = true;
+    }
+
+    void end() {
+        if (!_is_recording) return;
+        _is_recording = false;
+        _takes++;
+    }
+
+    //Audio callback side.
+    inline void write(float in0, float in1) {
+        _energy += in0 * in0 + in1 * in1;
+        if (++_frame < kHop) return;
+        auto rms = sqrtf(_energy / kHop);
+        auto rise = rms - _rms;
+        _values[_count % kHops] = rise > 0 ? rise : 0;
+        _rms = rms;
+        _energy = 0;
+        _frame = 0;
+        _count++;
+    }
+
+    bool is_recording() const { return _is_recording; }
+
+    //Finished takes since power on, tells a new take from the one already seen.
+    uint32_t takes() const { return _takes; }
+
+    //Hops of the last take that are still in the ring.
+    size_t size() const { return _count < kHops ? _count : kHops; }
+
+    //Oldest first.
+    float at(size_t index) const {
+        auto first = _count < kHops ? 0 : _count - kHops;
+        return _values[(first + index) % kHops];
+    }
+
+private:
+    std::array<float, kHops> _values {};
+    size_t _count = 0;
+    size_t _frame = 0;
+    float _energy = 0;
+    float _rms = 0;
+    volatile bool _is_recording = false;
+    volatile uint32_t _takes = 0;
+};
+
+}
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "bit.index.h"
+
+namespace blptls {
+namespace spotykach {
+
+/*
+Energy based onset detector that runs on the recorded signal.
+Energy is accumulated per hop of kHop frames. A hop is marked
+as an onset if its energy rises well above the running average.
+One bit per hop is stored, i.e. under 1 KB for the 10 s source.
+*/
+template <size_t kLength>
+class OnsetIndex {
+public:
+    static constexpr size_t kHop = 64;
+    static constexpr size_t kNone = SIZE_MAX;
+
+    OnsetIndex() { reset(); }
+
+    void reset() {
+        _bits.reset();
+        _energy = 0;
+        _average = 0;
+        _hops_since_onset = kMinGap;
+    }
+
+    //Starts over at a hop, e.g. of a restored chunk, with the average energy of the hops before.
+    void begin(float average) {
+        _energy = 0;
+        _average = average;
+        _hops_since_onset = kMinGap;
+    }
+
+    inline void write(size_t frame, float in0, float in1) {
+        _energy += in0 * in0 + in1 * in1;
+        if ((frame & (kHop - 1)) == kHop - 1) evaluate(frame / kHop);
+    }
+
+    //Closest onset within the tolerance, kNone if there is none.
+    size_t nearest(size_t frame, size_t tolerance) const {
+        auto hop = _bits.nearest(frame / kHop, tolerance / kHop);
+        return hop == kNone ? kNone : hop * kHop;
+    }
+
+private:
+    static constexpr float kRise = 4.f;
+    static constexpr float kFloor = 1e-3f * kHop;
+    static constexpr float kAverageK = 0.1f;
+    static constexpr size_t kMinGap = 8;
+
+    void evaluate(size_t hop) {
+        auto is_onset = _hops_since_onset >= kMinGap && _energy > kRise * _average + kFloor;
+        _bits.set(hop, is_onset);
+        _hops_since_onset = is_onset ? 0 : _hops_since_onset + 1;
+        _average += kAverageK * (_energy - _average);
+        _energy = 0;
+    }
+
+    BitIndex<(kLength + kHop - 1) / kHop> _bits;
+    float _energy;
+    float _average;
+    size_t _hops_since_onset;
+};
+
+}
+}
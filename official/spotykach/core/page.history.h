@@ -0,0 +1,179 @@
+#pragma once
+
+#include <array>
+#include <algorithm>
+#include <stddef.h>
+#include <stdint.h>
+#include "bit.index.h"
+
+namespace blptls {
+namespace spotykach {
+
+/*
+Copy-on-write undo history of a stereo buffer.
+A page is copied to the arena before a take first overwrites it,
+a part at a time if need be, so the copy can run ahead of the take.
+Pages are stored in the arena in order, so every take is a contiguous run
+and the oldest takes are dropped from the front when the arena
+or the depth runs out. Undo swaps the pages of a take with the buffer,
+so the same swap redoes it, both cost only the pages the take touched.
+The swap is done a page per step(), a take can be megabytes.
+*/
+template <size_t kLength, size_t kPageLength, size_t kSlots, size_t kDepth>
+class PageHistory {
+public:
+    static constexpr size_t kPages = (kLength + kPageLength - 1) / kPageLength;
+
+    //Without an arena nothing is saved.
+    void initialize(float* arena0, float* arena1) {
+        _arena[0] = arena0;
+        _arena[1] = arena1;
+        clear();
+    }
+
+    void clear() {
+        _begin = 0;
+        _end = 0;
+        _count = 0;
+        _undone = 0;
+        _is_saving = false;
+        _swap_next = 0;
+        _swap_end = 0;
+        _copying = kNone;
+        _copied = 0;
+    }
+
+    //Undone takes can't be redone once a new take begins.
+    void begin_take() {
+        if (!_arena[0]) return;
+        abandon();
+        _count -= _undone;
+        _undone = 0;
+        _end = _count > 0 ? _takes[_count - 1].end : _begin;
+        //A take that didn't write anything isn't worth an undo step.
+        if (_count > 0 && _takes[_count - 1].begin == _end) _count--;
+        if (_count == kDepth) drop_oldest();
+        _takes[_count++] = { _end, _end };
+        _saved.reset();
+        _is_saving = true;
+    }
+
+    /*
+    Copies up to frames more of the page. The page has to be saved
+    before the take writes to it. Starting another page gives up
+    the one that's partly copied. Returns true once the page is saved.
+    */
+    inline bool save(size_t page, float* const* buffer, size_t frames = kPageLength) {
+        if (!_is_saving || _saved.test(page)) return true;
+        if (_copying != page) {
+            abandon();
+            if (_end - _begin == kSlots) {
+                //The take alone outgrew the arena, it can't be undone.
+                if (_count == 1) {
+                    clear();
+                    return true;
+                }
+                drop_oldest();
+            }
+            _pages[_end % kSlots] = page;
+            _takes[_count - 1].end = ++_end;
+            _copying = page;
+            _copied = 0;
+        }
+        auto slot = (_end - 1) % kSlots;
+        auto from = page * kPageLength;
+        auto to = std::min(_copied + frames, page_frames(page));
+        for (int c = 0; c < 2; c++) {
+            std::copy(buffer[c] + from + _copied, buffer[c] + from + to, _arena[c] + slot * kPageLength + _copied);
+        }
+        _copied = to;
+        if (_copied < page_frames(page)) return false;
+        _saved.set(page, true);
+        _copying = kNone;
+        return true;
+    }
+
+    bool is_saved(size_t page) const { return !_is_saving || _saved.test(page); }
+
+    //Undo and redo start the swap, no take should begin till it's done.
+    bool undo() {
+        if (_undone == _count || is_swapping()) return false;
+        abandon();
+        _is_saving = false;
+        start_swap(_takes[_count - 1 - _undone]);
+        _undone++;
+        return true;
+    }
+
+    bool redo() {
+        if (_undone == 0 || is_swapping()) return false;
+        _undone--;
+        start_swap(_takes[_count - 1 - _undone]);
+        return true;
+    }
+
+    //Swaps a page, on_page is called with it. Returns true while there are more.
+    template <typename F>
+    bool step(float* const* buffer, F on_page) {
+        if (!is_swapping()) return false;
+        auto slot = _swap_next++ % kSlots;
+        auto page = _pages[slot];
+        auto from = page * kPageLength;
+        auto frames = page_frames(page);
+        for (int c = 0; c < 2; c++) std::swap_ranges(buffer[c] + from, buffer[c] + from + frames, _arena[c] + slot * kPageLength);
+        on_page(page);
+        return is_swapping();
+    }
+
+    bool is_swapping() const { return _swap_next < _swap_end; }
+
+    size_t used_pages() const { return _end - _begin; }
+    size_t depth() const { return _count - _undone; }
+
+private:
+    struct Take {
+        size_t begin;
+        size_t end;
+    };
+
+    static constexpr size_t page_frames(size_t page) {
+        return std::min(kPageLength, kLength - page * kPageLength);
+    }
+
+    static constexpr size_t kNone = SIZE_MAX;
+
+    //A partly copied page is the last one of the take, it goes.
+    void abandon() {
+        if (_copying == kNone) return;
+        _takes[_count - 1].end = --_end;
+        _copying = kNone;
+    }
+
+    void drop_oldest() {
+        _begin = _takes[0].end;
+        std::copy(_takes.begin() + 1, _takes.begin() + _count, _takes.begin());
+        _count--;
+    }
+
+    void start_swap(const Take& take) {
+        _swap_next = take.begin;
+        _swap_end = take.end;
+    }
+
+    float* _arena[2];
+    std::array<uint16_t, kSlots> _pages;
+    std::array<Take, kDepth> _takes;
+    BitIndex<kPages> _saved;
+    size_t _begin;
+    size_t _end;
+    size_t _count;
+    size_t _undone;
+    size_t _swap_next;
+    size_t _swap_end;
+    size_t _copying;
+    size_t _copied;
+    bool _is_saving;
+};
+
+}
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <array>
+#include <algorithm>
+#include <stdint.h>
+#include "globals.h"
+
+namespace blptls {
+namespace spotykach {
+
+static constexpr uint32_t kMaxPatternSteps { 64 };
+
+/*
+Trigger grid resolved at compile time.
+points - ticks from the pattern start, ascending.
+next - index of the first point at or after a grid step,
+so the next point for any tick is found without scanning.
+*/
+struct Pattern {
+    uint32_t step_ticks;
+    uint32_t steps;
+    uint32_t ticks;
+    uint32_t points_count;
+    std::array<uint16_t, kMaxPatternSteps> points;
+    std::array<uint8_t, kMaxPatternSteps> next;
+
+    constexpr uint32_t beats() const { return ticks / kPPQN; }
+
+    constexpr uint32_t next_index(uint32_t tick) const {
+        auto step = (tick + step_ticks - 1) / step_ticks;
+        return step < steps ? next[step] : 0;
+    }
+};
+
+using StepMask = std::array<bool, kMaxPatternSteps>;
+
+/*
+Not constexpr on purpose: a pattern table that calls it fails to compile
+with this name in the error. Patterns built at run time are clamped instead.
+*/
+inline void pattern_exceeds_kMaxPatternSteps() {}
+
+static constexpr Pattern make_pattern(const StepMask& mask, uint32_t steps, uint32_t step_ticks) {
+    Pattern p {};
+    p.step_ticks = step_ticks;
+    p.steps = steps;
+    p.ticks = steps * step_ticks;
+    for (uint32_t i = 0; i < steps; i++) {
+        if (mask[i]) p.points[p.points_count++] = static_cast<uint16_t>(i * step_ticks);
+    }
+    //Steps past the last point wrap to the first point of the next cycle.
+    for (uint32_t i = 0, point = 0; i < steps; i++) {
+        while (point < p.points_count && p.points[point] < i * step_ticks) point++;
+        p.next[i] = point < p.points_count ? point : 0;
+    }
+    return p;
+}
+
+/*
+Christoffel word of the given onsets count over the number of steps,
+same construction the trigger used to run on every pattern change.
+rotation - steps to delay the pattern by, bars - times to repeat it.
+steps * bars has to fit into kMaxPatternSteps.
+*/
+static constexpr Pattern make_cword_pattern(uint32_t onsets, uint32_t steps = 16, uint32_t rotation = 0, uint32_t bars = 1, uint32_t step_ticks = kPPQN / 4) {
+    if (steps * bars > kMaxPatternSteps) {
+        pattern_exceeds_kMaxPatternSteps();
+        steps = std::min(steps, kMaxPatternSteps);
+        bars = kMaxPatternSteps / steps;
+    }
+    StepMask word {};
+    uint32_t y = onsets, a = y;
+    uint32_t x = steps - onsets, b = x;
+
+    word[0] = true;
+
+    uint32_t i = 1;
+    while (a != b && i < steps) {
+        if (a > b) {
+            word[i] = true;
+            b += x;
+        }
+        else {
+            word[i] = false;
+            a += y;
+        }
+        i++;
+    }
+
+    if (i < steps) {
+        word[i] = false;
+        i++;
+    }
+
+    const auto offset = i;
+    for (i = 0; i + offset < steps; i++) {
+        word[i + offset] = word[i];
+    }
+
+    StepMask mask {};
+    const auto total = steps * bars;
+    for (i = 0; i < total; i++) {
+        mask[(i + rotation) % total] = word[i % steps];
+    }
+    return make_pattern(mask, total, step_ticks);
+}
+
+/*
+Evenly spaced points. The pattern is extended until it fills
+at least one measure and ends on a beat, so dotted and triplet
+steps produce multi-bar patterns.
+*/
+static constexpr Pattern make_even_pattern(uint32_t step) {
+    StepMask mask {};
+    uint32_t steps { 0 };
+    uint32_t length { 0 };
+    while ((length % kPPQN || length < kPPQN * kBeatsPerMeasure) && steps < kMaxPatternSteps) {
+        mask[steps++] = true;
+        length += step;
+    }
+    return make_pattern(mask, steps, step);
+}
+
+static constexpr std::array<Pattern, EvenStepsCount> EvenPatterns = [] {
+    std::array<Pattern, EvenStepsCount> t {};
+    for (int i = 0; i < EvenStepsCount; i++) t[i] = make_even_pattern(EvenSteps[i]);
+    return t;
+}();
+
+static constexpr std::array<Pattern, CWordsCount> CWordPatterns = [] {
+    std::array<Pattern, CWordsCount> t {};
+    for (int i = 0; i < CWordsCount; i++) t[i] = make_cword_pattern(CWords[i]);
+    return t;
+}();
+
+}
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <array>
+#include <algorithm>
+#include <math.h>
+#include <stddef.h>
+#include "i.source.h"
+
+namespace blptls {
+namespace spotykach {
+
+struct LevelCell {
+    float min;
+    float max;
+    float energy;
+};
+
+/*
+Min / max / energy mipmap of the recorded signal.
+Level 0 summarizes kHop frames, every next level kFan cells
+of the previous one (64 / 1024 / 16384 frames). Cells are
+refreshed as the source is written, so a level query never
+touches the audio itself.
+*/
+template <size_t kLength>
+class PeakPyramid {
+public:
+    static constexpr size_t kHop = 64;
+    static constexpr size_t kFan = 16;
+    static constexpr size_t kCells0 = (kLength + kHop - 1) / kHop;
+    static constexpr size_t kCells1 = (kCells0 + kFan - 1) / kFan;
+    static constexpr size_t kCells2 = (kCells1 + kFan - 1) / kFan;
+
+    void initialize(LevelCell* level0) {
+        _level0 = level0;
+        reset();
+    }
+
+    //Level 0 cells are left to clear(), called as the audio itself is cleared.
+    void reset() {
+        _level1.fill({ 0, 0, 0 });
+        _level2.fill({ 0, 0, 0 });
+        reset_hop();
+    }
+
+    //Starts over at a hop.
+    void begin() {
+        reset_hop();
+    }
+
+    inline void write(size_t frame, float in0, float in1) {
+        _hop.min = std::min(_hop.min, std::min(in0, in1));
+        _hop.max = std::max(_hop.max, std::max(in0, in1));
+        _hop.energy += 0.5f * (in0 * in0 + in1 * in1);
+        if ((frame & (kHop - 1)) == kHop - 1) commit(frame / kHop);
+    }
+
+    void clear(size_t from, size_t to) {
+        std::fill(_level0 + from / kHop, _level0 + std::min((to + kHop - 1) / kHop, kCells0), LevelCell { 0, 0, 0 });
+    }
+
+    //Level over [from, to), rounded outwards to whole hops.
+    SignalLevel level(size_t from, size_t to) const {
+        return level(from, to, [](size_t) { return false; });
+    }
+
+    /*
+    Same, but level 0 cells of the groups of kFan for which
+    is_stale(group) holds count as silence, see Source::level.
+    */
+    template <typename Stale>
+    SignalLevel level(size_t from, size_t to, Stale&& is_stale) const {
+        LevelCell acc { 0, 0, 0 };
+        if (to <= from) return { 0, 0, 0 };
+        auto c0 = from / kHop;
+        auto c_end = std::min((to + kHop - 1) / kHop, kCells0);
+        auto frames = (c_end - c0) * kHop;
+        while (c0 < c_end) {
+            if (c0 % (kFan * kFan) == 0 && c0 + kFan * kFan <= c_end) {
+                merge(acc, _level2[c0 / (kFan * kFan)]);
+                c0 += kFan * kFan;
+            }
+            else if (c0 % kFan == 0 && c0 + kFan <= c_end) {
+                merge(acc, _level1[c0 / kFan]);
+                c0 += kFan;
+            }
+            else {
+                if (!is_stale(c0 / kFan)) merge(acc, _level0[c0]);
+                c0 ++;
+            }
+        }
+        return { acc.min, acc.max, frames > 0 ? sqrtf(acc.energy / frames) : 0 };
+    }
+
+private:
+    static inline void merge(LevelCell& acc, const LevelCell& c) {
+        acc.min = std::min(acc.min, c.min);
+        acc.max = std::max(acc.max, c.max);
+        acc.energy += c.energy;
+    }
+
+    void reset_hop() {
+        _hop = { 0, 0, 0 };
+    }
+
+    //Parent cells are rebuilt from their children since
+    //overdubbing can lower a peak as well as raise it.
+    void commit(size_t cell) {
+        _level0[cell] = _hop;
+        reset_hop();
+
+        auto c1 = cell / kFan;
+        LevelCell acc { 0, 0, 0 };
+        auto end = std::min((c1 + 1) * kFan, kCells0);
+        for (auto i = c1 * kFan; i < end; i++) merge(acc, _level0[i]);
+        _level1[c1] = acc;
+
+        auto c2 = c1 / kFan;
+        acc = { 0, 0, 0 };
+        end = std::min((c2 + 1) * kFan, kCells1);
+        for (auto i = c2 * kFan; i < end; i++) merge(acc, _level1[i]);
+        _level2[c2] = acc;
+    }
+
+    LevelCell* _level0;
+    std::array<LevelCell, kCells1> _level1;
+    std::array<LevelCell, kCells2> _level2;
+    LevelCell _hop;
+};
+
+}
+}
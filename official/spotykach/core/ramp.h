@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stddef.h>
+#include "globals.h"
+
+namespace blptls {
+namespace spotykach {
+
+/*
+Parameter glide for knob driven values. A new target is reached
+linearly over kParameterRampFrames, about one controller period,
+so the steps the controller makes are joined into a continuous line.
+The line is cut into per block segments: begin_block() works out
+the increment once, next() adds it for every frame.
+*/
+class Ramp {
+public:
+    explicit Ramp(float value = 0) { jump(value); }
+
+    //Control side.
+    void set(float target) { _target = target; }
+
+    //Skips the glide, the audio side only.
+    void jump(float value) {
+        _target = _goal = _value = _end = value;
+        _step = 0;
+        _left = 0;
+    }
+
+    //Audio side, once per block, before next() is called for its frames.
+    void begin_block(size_t frames) {
+        _value = _end;
+        if (_target != _goal) {
+            _goal = _target;
+            _left = kParameterRampFrames;
+        }
+        if (_left > frames) {
+            _end = _value + (_goal - _value) * frames / _left;
+            _left -= frames;
+        }
+        else {
+            _end = _goal;
+            _left = 0;
+        }
+        _step = (_end - _value) / frames;
+    }
+
+    inline float next() { return _value += _step; }
+
+    float value() const { return _value; }
+    float target() const { return _target; }
+
+private:
+    float _target;
+    float _goal;
+    float _value;
+    float _end;
+    float _step;
+    size_t _left;
+};
+
+}
+}
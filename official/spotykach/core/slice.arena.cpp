@@ -0,0 +1,66 @@
+#include "slice.arena.h"
+#include "buffers.h"
+
+using namespace blptls;
+using namespace spotykach;
+
+SliceArena::SliceArena() : _head { 0 } {
+    _regions.fill({ 0, 0, false, false });
+}
+
+void SliceArena::initialize() {
+    _buffer[0] = Buffers::pool().slice_arena_buffer();
+    _buffer[1] = Buffers::pool().slice_arena_buffer();
+}
+
+/*
+Tries the head first, then the start of the ring,
+then the frames right after every playing slice.
+*/
+size_t SliceArena::allocate(size_t slot, size_t frames) {
+    auto& own = _regions[slot];
+    own.is_live = false;
+    own.is_valid = false;
+    if (frames == 0 || frames > kSliceArenaLength) return kNone;
+
+    auto try_at = [this, slot, frames](size_t begin) {
+        if (begin + frames > kSliceArenaLength || !is_free(begin, begin + frames, slot)) return false;
+        take(slot, begin, begin + frames);
+        return true;
+    };
+
+    if (try_at(_head) || try_at(0)) return own.begin;
+    for (size_t i = 0; i < kSlicesCount; i++) {
+        if (i != slot && _regions[i].is_live && try_at(_regions[i].end)) return own.begin;
+    }
+    return kNone;
+}
+
+bool SliceArena::retain(size_t slot) {
+    auto& r = _regions[slot];
+    if (!r.is_valid) return false;
+    r.is_live = true;
+    return true;
+}
+
+void SliceArena::release(size_t slot) {
+    _regions[slot].is_live = false;
+}
+
+bool SliceArena::is_free(size_t begin, size_t end, size_t slot) const {
+    for (size_t i = 0; i < kSlicesCount; i++) {
+        auto& r = _regions[i];
+        if (i != slot && r.is_live && begin < r.end && r.begin < end) return false;
+    }
+    return true;
+}
+
+//Ended slices whose frames are overwritten lose them.
+void SliceArena::take(size_t slot, size_t begin, size_t end) {
+    for (size_t i = 0; i < kSlicesCount; i++) {
+        auto& r = _regions[i];
+        if (i != slot && r.is_valid && begin < r.end && r.begin < end) r.is_valid = false;
+    }
+    _regions[slot] = { begin, end, true, true };
+    _head = end < kSliceArenaLength ? end : 0;
+}
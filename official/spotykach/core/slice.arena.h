@@ -0,0 +1,51 @@
+#pragma once
+
+#include <array>
+#include <stddef.h>
+#include <stdint.h>
+#include "globals.h"
+
+namespace blptls {
+namespace spotykach {
+
+/*
+Per engine ring of slice audio. Every slice takes exactly
+the frames it needs: the head bumps forward and wraps to the start
+when the end is reached, like delay memory does. Ended slices keep
+their frames, so a retriggered slice replays them, until the head
+runs over them. Frames of playing slices are never handed out.
+*/
+class SliceArena {
+public:
+    static constexpr size_t kNone = SIZE_MAX;
+
+    SliceArena();
+
+    void initialize();
+
+    //Start of the frames given to the slot, kNone if they don't fit.
+    size_t allocate(size_t slot, size_t frames);
+    //Takes the last frames of the slot back, false if they were handed out since.
+    bool retain(size_t slot);
+    void release(size_t slot);
+
+    float* channel(int c) { return _buffer[c]; }
+
+private:
+    struct Region {
+        size_t begin;
+        size_t end;
+        bool is_live;
+        bool is_valid;
+    };
+
+    bool is_free(size_t begin, size_t end, size_t slot) const;
+    void take(size_t slot, size_t begin, size_t end);
+
+    float* _buffer[2];
+    std::array<Region, kSlicesCount> _regions;
+    size_t _head;
+};
+
+}
+}
@@ -2,26 +2,32 @@
 #include <algorithm>
 #include <cstring>
 #include "slice.buffer.h"
-#include "buffers.h"
+#include "access.trace.h"
 
 using namespace blptls;
 using namespace spotykach;
 
-SliceBuffer::SliceBuffer(): _size { kSliceBufferLength } {
+SliceBuffer::SliceBuffer(): _arena { nullptr }, _slot { 0 }, _size { 0 }, _writeHead { 0 } {
+}
+
+void SliceBuffer::attach(SliceArena& arena, size_t slot) {
+    _arena = &arena;
+    _slot = slot;
 }
 
 void SliceBuffer::initialize() {
-    _buffer[0] = Buffers::pool().sliceBuffer();
-    _buffer[1] = Buffers::pool().sliceBuffer();
     reset();
 }
 
 float SliceBuffer::read(int channel, uint32_t frame) {
     if (frame >= _writeHead) return 0;
+    TRACE_READ(SliceBuffer, &_buffer[channel][frame]);
     return _buffer[channel][frame];
 }
 
 void SliceBuffer::write(float in0, float in1) {
+    TRACE_WRITE(SliceBuffer, &_buffer[0][_writeHead]);
+    TRACE_WRITE(SliceBuffer, &_buffer[1][_writeHead]);
     _buffer[0][_writeHead] = in0;
     _buffer[1][_writeHead] = in1;
     _writeHead ++;
@@ -38,3 +44,24 @@ bool SliceBuffer::isFull() {
 void SliceBuffer::reset() {
     rewind();
 }
+
+bool SliceBuffer::allocate(size_t frames) {
+    rewind();
+    auto begin = _arena->allocate(_slot, frames);
+    if (begin == SliceArena::kNone) {
+        _size = 0;
+        return false;
+    }
+    _buffer[0] = _arena->channel(0) + begin;
+    _buffer[1] = _arena->channel(1) + begin;
+    _size = frames;
+    return true;
+}
+
+bool SliceBuffer::retain() {
+    return _size > 0 && _arena->retain(_slot);
+}
+
+void SliceBuffer::release() {
+    _arena->release(_slot);
+}
@@ -2,22 +2,31 @@
 
 #include <vector>
 #include "i.slice.buffer.h"
+#include "slice.arena.h"
 
 class SliceBuffer: public ISliceBuffer {
 public:
     SliceBuffer();
 
+    void attach(blptls::spotykach::SliceArena& arena, size_t slot);
+
     void initialize() override;
     float read(int, uint32_t) override;
     void write(float, float) override;
-    unsigned long writeHead() override { return _writeHead; }
+    uint32_t writeHead() override { return _writeHead; }
     void rewind() override;
     bool isFull() override;
     void reset() override;
+
+    bool allocate(size_t frames) override;
+    bool retain() override;
+    void release() override;
     
     ~SliceBuffer() {};
     
 private:
+    blptls::spotykach::SliceArena* _arena;
+    size_t _slot;
     uint32_t _size;
     uint32_t _writeHead;
     float* _buffer[2];
@@ -1,5 +1,7 @@
 #include "slice.h"
 #include "globals.h"
+#include "buffers.h"
+#include <algorithm>
 
 using namespace blptls;
 using namespace spotykach;
@@ -9,74 +11,178 @@ Slice::Slice(ISource& inSource, ISliceBuffer& inBuffer, IEnvelope& inEnvelope) :
     _envelope   { inEnvelope },
     _buffer     { inBuffer },
     _active     { false },
+    _prepared   { false },
+    _retriggering { false },
+    _retrigger  { },
+    _tail       { },
     _length     { 0 },
     _offset     { 0 },
     _iterator   { 0 },
     _reverse    { false },
+    _aligned    { false },
+    _cached     { false },
+    _needsReset { true },
     _volume     { 1.0 }
     {}
 
 void Slice::initialize() {
     _buffer.initialize();
-    _pitch.initialize(kSampleRate, 4096);
+    _pitch.initialize(Buffers::pool().slice_pitch_buf());
 	_pitch.setShift(0.5);
 }
 
-void Slice::activate(size_t offset, size_t length, bool reverse, float pitch, float volume) {
-    if (_needsReset || offset != _offset) {
-        _buffer.reset();
-        _needsReset = false;
+/*
+Nothing is played till start() is called. A slice that's still
+playing keeps on till then, its new parameters wait in _retrigger.
+*/
+void Slice::prepare(size_t offset, size_t length, bool reverse, float pitch, float volume, bool aligned) {
+    Parameters p { offset, length, reverse, pitch, volume, aligned };
+    _prepared = true;
+    _retriggering = _active;
+    if (_retriggering) _retrigger = p;
+    else setup(p);
+}
+
+void Slice::start() {
+    if (!_prepared) return;
+    _prepared = false;
+    if (_retriggering) {
+        _retriggering = false;
+        if (_active) hand_over();
+        else setup(_retrigger);
     }
-    _offset = offset;
-    _length = length;
-    _reverse = reverse;
-    _iterator = 0;
-    _pitch.setShift(pitch);
     _active = true;
-    _volume = volume;
+}
+
+void Slice::cancel() {
+    if (!_prepared) return;
+    _prepared = false;
+    if (_retriggering) _retriggering = false;
+    else if (_cached) _buffer.release();
+}
+
+/*
+A slice retriggered at the same place replays the frames it cached,
+otherwise it takes new room in the arena. If there's none,
+it plays straight from the source. Returns true if the frames are reused.
+*/
+bool Slice::setup(const Parameters& p) {
+    auto reuse = !_needsReset && p.offset == _offset && p.length == _length && _buffer.retain();
+    if (!reuse) _cached = _buffer.allocate(p.length);
+    _needsReset = false;
+    _offset = p.offset;
+    _length = p.length;
+    _reverse = p.reverse;
+    _aligned = p.aligned;
+    _iterator = 0;
+    _pitch.setShift(p.pitch);
+    _volume = p.volume;
+    return reuse;
+}
+
+/*
+Retrigger of a playing slice: the old playback becomes the tail and fades
+out along the decay quarter sine while the new one fades in along
+the attack one, an equal power crossfade over the attack length.
+The tail reads the cached frames if they're reused, they are kept
+as the new playback captures the same ones, otherwise the source.
+*/
+void Slice::hand_over() {
+    Tail tail;
+    tail.offset = _offset;
+    tail.length = _length;
+    tail.iterator = _iterator;
+    tail.attack = declick_length(_envelope.attackLength());
+    tail.decay = declick_length(_envelope.decayLength());
+    tail.reverse = _reverse;
+    tail.volume = _volume;
+    auto cached = _cached;
+    auto reuse = setup(_retrigger);
+    tail.buffered = cached && reuse;
+    tail.fade = declick_length(_envelope.attackLength());
+    tail.left = std::min(tail.fade, tail.length - tail.iterator);
+    _tail = tail;
 }
 
 void Slice::synthesize(float *out0, float* out1) {
-    if (!_buffer.isFull()) {
-        auto readPosition = 0;
-        if (_reverse) {
-            readPosition = _offset + _length - _buffer.writeHead();
+    float out0Val = 0;
+    float out1Val = 0;
+    if (_cached) {
+        if (!_buffer.isFull()) {
+            float s0 = 0;
+            float s1 = 0;
+            _source.read(s0, s1, read_position(_buffer.writeHead()));
+            _buffer.write(s0, s1);
         }
-        else {
-            readPosition = _offset + _buffer.writeHead();
-        }
-        float s0 = 0;
-        float s1 = 0;
-        _source.read(s0, s1, readPosition);
-        _buffer.write(s0, s1);
+        out0Val = _buffer.read(0, _iterator);
+        out1Val = _buffer.read(1, _iterator);
     }
-    
-    auto out0Val = _buffer.read(0, _iterator);
-    auto out1Val = _buffer.read(1, _iterator);
-    
-    auto attenuation = 1.f;
-    if (_iterator < _envelope.attackLength()) {
-        attenuation = _envelope.attackAttenuation(_iterator);
-    }
-    else if (_iterator > _length - _envelope.decayLength()) {
-        attenuation = _envelope.decayAttenuation(_iterator - _length + _envelope.decayLength());
+    else {
+        _source.read(out0Val, out1Val, read_position(_iterator));
     }
     
+    auto attack = declick_length(_envelope.attackLength());
+    auto decay = declick_length(_envelope.decayLength());
+    auto attenuation = this->attenuation(_iterator, _length, attack, decay);
+    
     *out0 = out0Val * attenuation * _volume;
     *out1 = out1Val * attenuation * _volume;
+    if (_tail.left > 0) add_tail(out0, out1);
     
     _pitch.process(out0, out1);
 
     next();
 }
 
+void Slice::add_tail(float* out0, float* out1) {
+    float s0 = 0;
+    float s1 = 0;
+    if (_tail.buffered) {
+        s0 = _buffer.read(0, _tail.iterator);
+        s1 = _buffer.read(1, _tail.iterator);
+    }
+    else {
+        auto frame = _tail.reverse ? _tail.offset + _tail.length - _tail.iterator : _tail.offset + _tail.iterator;
+        _source.read(s0, s1, frame);
+    }
+    auto gain = attenuation(_tail.iterator, _tail.length, _tail.attack, _tail.decay) * _tail.volume;
+    gain *= _envelope.decayAttenuation(_tail.fade - _tail.left, _tail.fade);
+    *out0 += s0 * gain;
+    *out1 += s1 * gain;
+    _tail.iterator++;
+    _tail.left--;
+}
+
+float Slice::attenuation(size_t iterator, size_t length, size_t attack, size_t decay) {
+    if (iterator < attack) return _envelope.attackAttenuation(iterator, attack);
+    if (iterator > length - decay) return _envelope.decayAttenuation(iterator - length + decay, decay);
+    return 1.f;
+}
+
 void Slice::next() {
     _iterator ++;
     if (_iterator == _length) {
         _active = false;
+        _tail.left = 0;
+        if (_cached) _buffer.release();
     }
 }
 
+size_t Slice::read_position(size_t frame) {
+    return _reverse ? _offset + _length - frame : _offset + frame;
+}
+
+/*
+Slices whose both ends sit on zero crossings only need a short declick.
+Longer, tempo derived crossfades are kept as they are.
+*/
+size_t Slice::declick_length(long envelope_length) {
+    if (envelope_length <= 0) return 0;
+    auto length = static_cast<size_t>(envelope_length);
+    if (!_aligned || length > kDeclickFrames) return length;
+    return std::min(length, static_cast<size_t>(kAlignedDeclickFrames));
+}
+
 void Slice::setNeedsReset() {
     _needsReset = true;
 }
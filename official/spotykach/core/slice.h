@@ -16,23 +16,57 @@ public:
     
     bool isActive() { return _active; };
     bool isInactive() { return !_active; };
+    //Frames played since the slice started.
+    size_t position() { return _iterator; };
     void initialize();
-    void activate(size_t offset, size_t length, bool reverse, float pitch, float volume);
+    void prepare(size_t offset, size_t length, bool reverse, float pitch, float volume, bool aligned = false);
+    void start();
+    //Gives up a prepared slice that won't be started.
+    void cancel();
     void synthesize(float *out0, float* out1);
     void setNeedsReset();
     
 private :
+    struct Parameters {
+        size_t offset;
+        size_t length;
+        bool reverse;
+        float pitch;
+        float volume;
+        bool aligned;
+    };
+
+    //Playback of a retriggered slice, fading out under the new one.
+    struct Tail {
+        size_t offset;
+        size_t length;
+        size_t iterator;
+        size_t attack;
+        size_t decay;
+        size_t fade;
+        size_t left;
+        bool reverse;
+        bool buffered;
+        float volume;
+    };
+
     ISource& _source;
     IEnvelope& _envelope;
     ISliceBuffer& _buffer;
-    PitchShift _pitch;
+    SlicePitchShift _pitch;
 
     bool _active;
+    bool _prepared;
+    bool _retriggering;
+    Parameters _retrigger;
+    Tail _tail;
     
     size_t _length;
     size_t _offset;
     size_t _iterator;
     bool _reverse;
+    bool _aligned;
+    bool _cached;
     
     bool _needsReset;
     
@@ -40,7 +74,13 @@ private :
     float *_declickOut;
     float _volume;
     
+    bool setup(const Parameters& p);
+    void hand_over();
+    void add_tail(float* out0, float* out1);
+    float attenuation(size_t iterator, size_t length, size_t attack, size_t decay);
     void next();
+    size_t read_position(size_t frame);
+    size_t declick_length(long envelope_length);
 };
 
 }
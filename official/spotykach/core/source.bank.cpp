@@ -0,0 +1,61 @@
+#include "source.bank.h"
+#include "buffers.h"
+
+using namespace blptls;
+using namespace spotykach;
+
+SourceBank::SourceBank() :
+    _active     { 0 },
+    _previous   { 0 },
+    _selected   { 0 },
+    _fade       { 0 },
+    _sweep_slot { 0 }
+    {}
+
+void SourceBank::initialize() {
+    auto h0 = Buffers::pool().history_buffer();
+    auto h1 = Buffers::pool().history_buffer();
+    for (auto& s: _slots) s.initialize(h0, h1);
+}
+
+void SourceBank::select_slot(size_t slot) {
+    if (slot < kSourceSlots) _selected = slot;
+}
+
+//Called at trigger points and by idle engines.
+bool SourceBank::apply_selection() {
+    size_t selected = _selected;
+    if (selected == _active || !active().is_idle() || active().is_restoring()) return false;
+    active().clear_history();
+    _previous = _active;
+    _active = selected;
+    _fade = kSourceSwitchFrames;
+    return true;
+}
+
+//The crossfade advances with the recording, once per frame.
+void SourceBank::write(float in0, float in1) {
+    if (_fade > 0) _fade--;
+    active().write(in0, in1);
+}
+
+void SourceBank::read(float& out0, float& out1, size_t frame) {
+    active().read(out0, out1, frame);
+    if (_fade == 0) return;
+    float prev0, prev1;
+    _slots[_previous].read(prev0, prev1, frame);
+    auto k = static_cast<float>(_fade) / kSourceSwitchFrames;
+    out0 += k * (prev0 - out0);
+    out1 += k * (prev1 - out1);
+}
+
+//One slot per call, every slot keeps clearing its stale chunks.
+//A take being restored has the calls to itself.
+void SourceBank::sweep() {
+    if (active().is_restoring()) {
+        active().sweep();
+        return;
+    }
+    _slots[_sweep_slot].sweep();
+    _sweep_slot = (_sweep_slot + 1) % kSourceSlots;
+}
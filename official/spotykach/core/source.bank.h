@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include "source.h"
+#include "globals.h"
+#include "buffers.h"
+
+namespace blptls {
+namespace spotykach {
+
+/*
+Several recordings resident in SDRAM, one of them active.
+A switch is requested from the controls and applied at the next
+trigger point, once the active slot is done recording.
+Switching swaps the active slot, reads crossfade from the previous one.
+Slots share the undo memory, so undo history is dropped on a switch.
+*/
+class SourceBank: public ISource {
+public:
+    SourceBank();
+
+    void set_frozen(bool frozen) override { active().set_frozen(frozen); }
+    bool is_frozen() override { return active().is_frozen(); }
+    bool is_idle() override { return active().is_idle(); }
+    void set_antifreeze(bool value) override { active().set_antifreeze(value); }
+
+    size_t length() override { return active().length(); }
+
+    void set_cycle_start(size_t start) override { active().set_cycle_start(start); }
+
+    void initialize() override;
+
+    void write(float in0, float in1) override;
+    size_t read_head() override { return active().read_head(); }
+    void read(float& out0, float& out1, size_t frame) override;
+
+    size_t nearest_onset(size_t frame, size_t tolerance) override { return active().nearest_onset(frame, tolerance); }
+    SignalLevel level(size_t from, size_t to) override { return active().level(from, to); }
+    size_t nearest_zero_crossing(size_t frame, size_t tolerance) override { return active().nearest_zero_crossing(frame, tolerance); }
+
+    void reset() override { active().reset(); }
+    void sweep() override;
+
+    bool undo() override { return active().undo(); }
+    bool redo() override { return active().redo(); }
+    bool is_restoring() override { return active().is_restoring(); }
+
+    size_t slots_count() override { return kSourceSlots; }
+    size_t selected_slot() override { return _selected; }
+    void select_slot(size_t slot) override;
+    bool apply_selection() override;
+    void skip(size_t frames) override { _fade = _fade > frames ? _fade - frames : 0; }
+
+private:
+    Source& active() { return _slots[_active]; }
+
+    std::array<Source, kSourceSlots> _slots;
+    size_t _active;
+    size_t _previous;
+    volatile size_t _selected;
+    uint32_t _fade;
+    size_t _sweep_slot;
+};
+
+}
+}
@@ -1,20 +1,43 @@
 #include "source.h"
 #include "buffers.h"
+#include "access.trace.h"
+#include <algorithm>
+#include <string.h>
 
 using namespace blptls;
 using namespace spotykach;
 
 Source::Source() :
     _buffer_length   { kSourceBufferLength },
-    _antifreeze      { false },
     _write_head      { 0 },
     _read_head       { 0 },
     _sycle_start     { 0 },
     _rec_env_pos     { 0 },
-    _rec_env_pos_inc { 0 }
-    {}
+    _rec_env_pos_inc { 0 },
+    _antifreeze      { false },
+    _is_take_pending { false },
+    _epoch           { 0 },
+    _sweep_chunk     { 0 },
+    _sweep_skipped   { false },
+    _clearing        { kNoChunk },
+    _cleared         { 0 }
+    {
+        _chunk_epochs.fill(0);
+    }
 
+//A take waits for an undo or redo to be restored, see sweep().
 void Source::set_frozen(bool frozen) { 
+    _is_take_pending = !frozen && _history.is_swapping();
+    if (_is_take_pending) return;
+    if (!frozen && is_frozen()) {
+        _history.begin_take();
+        //Off the audio callback, the first chunks of the take are made ready here.
+        if (is_idle()) {
+            auto chunk = _write_head / kChunkLength;
+            prepare(chunk, kChunkLength);
+            prepare((chunk + 1) % kChunksCount, kChunkLength);
+        }
+    }
     _rec_env_pos_inc = frozen ? -1 : 1;
 }
 
@@ -30,13 +53,26 @@ void Source::set_cycle_start(size_t start) {
 }
 
 void Source::initialize() {
+    initialize(nullptr, nullptr);
+}
+
+void Source::initialize(float* history0, float* history1) {
+    static_assert(kHistoryPages == kHistoryPagesCount && kChunkLength == kHistoryPageLength, "Undo pages should be the chunks");
     _buffer[0] = Buffers::pool().sourceBuffer();
     _buffer[1] = Buffers::pool().sourceBuffer();
+    _levels.initialize(Buffers::pool().level_buffer());
+    _history.initialize(history0, history1);
     reset();
 }
 
 void Source::read(float& out0, float& out1, size_t frame) {
     frame %= _buffer_length;
+    if (!is_cleared(frame / kChunkLength)) {
+        out0 = out1 = 0;
+        return;
+    }
+    TRACE_READ(Source, &_buffer[0][frame]);
+    TRACE_READ(Source, &_buffer[1][frame]);
     out0 = _buffer[0][frame];
     out1 = _buffer[1][frame];
 }
@@ -48,18 +84,204 @@ void Source::write(float in0, float in1) {
       }
 
       if (_rec_env_pos > 0) {
+        //The next chunk is made ready a few frames at a time. This one is
+        //ready already unless the write head jumped, then what's left is done here.
+        auto chunk = _write_head / kChunkLength;
+        prepare(chunk, kChunkLength);
+        prepare((chunk + 1) % kChunksCount, kPrepareFrames);
         float rec_attenuation = static_cast<float>(_rec_env_pos) / static_cast<float>(kFadeLength);
+        TRACE_READ(Source, &_buffer[0][_write_head]);
+        TRACE_WRITE(Source, &_buffer[0][_write_head]);
+        TRACE_READ(Source, &_buffer[1][_write_head]);
+        TRACE_WRITE(Source, &_buffer[1][_write_head]);
         _buffer[0][_write_head] = in0 * rec_attenuation + _buffer[0][_write_head] * (1.f - rec_attenuation);
         _buffer[1][_write_head] = in1 * rec_attenuation + _buffer[1][_write_head] * (1.f - rec_attenuation);
+        _onsets.write(_write_head, _buffer[0][_write_head], _buffer[1][_write_head]);
+        _levels.write(_write_head, _buffer[0][_write_head], _buffer[1][_write_head]);
+        _crossings.write(_write_head, _buffer[0][_write_head], _buffer[1][_write_head]);
         _read_head = _write_head;
         if (++_write_head >= _buffer_length) _write_head = 0;
       }
 }
 
+/*
+Reset doesn't touch the audio. It only starts a new epoch,
+which marks every chunk as stale. Stale chunks read as silence
+and are zeroed either by sweep() from the main loop
+or by write() ahead of the recording, see prepare().
+*/
 void Source::reset() {
-    memset(_buffer[0], 0, _buffer_length * sizeof(float));
-    memset(_buffer[1], 0, _buffer_length * sizeof(float));
+    if (++_epoch == 0) {
+        _chunk_epochs.fill(0);
+        _epoch = 1;
+    }
+    _sweep_chunk = 0;
+    _sweep_skipped = false;
+    _clearing = kNoChunk;
     _write_head = 0;
     _read_head = 0;
     _sycle_start = 0;
+    _onsets.reset();
+    _levels.reset();
+    _crossings.reset();
+    _history.clear();
+}
+
+void Source::clear_chunk(size_t chunk) {
+    auto from = chunk * kChunkLength;
+    auto to = std::min(from + kChunkLength, _buffer_length);
+    memset(_buffer[0] + from, 0, (to - from) * sizeof(float));
+    memset(_buffer[1] + from, 0, (to - from) * sizeof(float));
+    _levels.clear(from, to);
+    _chunk_epochs[chunk] = _epoch;
+}
+
+/*
+Gets a chunk ready to be recorded: zeroed if it's stale, then saved
+for undo, up to frames of each per call. Returns true once it's ready.
+*/
+bool Source::prepare(size_t chunk, size_t frames) {
+    if (!is_cleared(chunk)) {
+        if (_clearing != chunk) {
+            _clearing = chunk;
+            _cleared = 0;
+        }
+        auto from = chunk * kChunkLength;
+        auto length = std::min(kChunkLength, _buffer_length - from);
+        auto to = std::min(_cleared + frames, length);
+        std::fill(_buffer[0] + from + _cleared, _buffer[0] + from + to, 0.f);
+        std::fill(_buffer[1] + from + _cleared, _buffer[1] + from + to, 0.f);
+        _cleared = to;
+        if (_cleared < length) return false;
+        _levels.clear(from, from + length);
+        _chunk_epochs[chunk] = _epoch;
+        _clearing = kNoChunk;
+    }
+    return _history.save(chunk, _buffer, frames);
+}
+
+/*
+Clears one stale chunk per call. The chunk being recorded and
+the next one are skipped, so sweep() and write() never zero
+the same memory concurrently. Skipped chunks are picked up
+by the next pass. While a take is restored, restores one chunk
+per call instead.
+*/
+void Source::sweep() {
+    if (_history.is_swapping()) {
+        _history.step(_buffer, [this](size_t chunk) { reindex(chunk); });
+        if (!_history.is_swapping() && _is_take_pending) set_frozen(false);
+        return;
+    }
+    auto write_chunk = _write_head / kChunkLength;
+    while (_sweep_chunk < kChunksCount) {
+        auto chunk = _sweep_chunk++;
+        if (is_cleared(chunk)) continue;
+        if (chunk == write_chunk || chunk == (write_chunk + 1) % kChunksCount) {
+            _sweep_skipped = true;
+            continue;
+        }
+        clear_chunk(chunk);
+        return;
+    }
+    if (_sweep_skipped) {
+        _sweep_skipped = false;
+        _sweep_chunk = 0;
+    }
+}
+
+/*
+Visits the blocks around the frame closest first and reads only
+those the index marks, until no block left can hold a closer crossing.
+*/
+size_t Source::nearest_zero_crossing(size_t frame, size_t tolerance) {
+    constexpr auto kBlock = decltype(_crossings)::kBlock;
+    frame %= _buffer_length;
+    auto first = (frame > tolerance ? frame - tolerance : 0) / kBlock;
+    auto last = std::min(frame + tolerance, _buffer_length - 1) / kBlock;
+
+    size_t nearest = SIZE_MAX;
+    size_t distance = tolerance + 1;
+    auto below = frame / kBlock;
+    auto above = below + 1;
+    scan_crossings(below, frame, nearest, distance);
+    while (true) {
+        auto below_d = below > first ? frame - (below * kBlock - 1) : SIZE_MAX;
+        auto above_d = above <= last ? above * kBlock - frame : SIZE_MAX;
+        if (std::min(below_d, above_d) >= distance) break;
+        if (below_d <= above_d) scan_crossings(--below, frame, nearest, distance);
+        else scan_crossings(above++, frame, nearest, distance);
+    }
+    return nearest;
+}
+
+void Source::scan_crossings(size_t block, size_t frame, size_t& nearest, size_t& distance) {
+    constexpr auto kBlock = decltype(_crossings)::kBlock;
+    if (!_crossings.crossed(block)) return;
+    //The first frame of the buffer has nothing before it to cross from.
+    auto from = std::max(block * kBlock, size_t(1));
+    auto to = std::min(block * kBlock + kBlock, _buffer_length);
+    if (!is_cleared((from - 1) / kChunkLength) || !is_cleared((to - 1) / kChunkLength)) return;
+
+    auto last = _buffer[0][from - 1] + _buffer[1][from - 1];
+    for (auto f = from; f < to; f++) {
+        auto value = _buffer[0][f] + _buffer[1][f];
+        auto d = f > frame ? f - frame : frame - f;
+        if ((value >= 0) != (last >= 0) && d < distance) {
+            nearest = f;
+            distance = d;
+        }
+        last = value;
+    }
+}
+
+/*
+Stale chunks read as silence, so their level 0 cells, left from
+before the reset, don't count. Upper levels are reset with the epoch.
+*/
+SignalLevel Source::level(size_t from, size_t to) {
+    auto is_stale = [this](size_t chunk) { return !is_cleared(chunk); };
+    auto length = to - from;
+    if (length >= _buffer_length) return _levels.level(0, _buffer_length, is_stale);
+    from %= _buffer_length;
+    to = from + length;
+    if (to <= _buffer_length) return _levels.level(from, to, is_stale);
+
+    auto head = _levels.level(from, _buffer_length, is_stale);
+    auto tail = _levels.level(0, to - _buffer_length, is_stale);
+    auto head_w = static_cast<float>(_buffer_length - from) / length;
+    return {
+        std::min(head.min, tail.min),
+        std::max(head.max, tail.max),
+        sqrtf(head.rms * head.rms * head_w + tail.rms * tail.rms * (1.f - head_w))
+    };
+}
+
+bool Source::undo() {
+    return is_idle() && _history.undo();
+}
+
+bool Source::redo() {
+    return is_idle() && _history.redo();
+}
+
+/*
+Restored chunks are run through the indices again as if they were recorded,
+starting from what's before the chunk rather than where the last write left them.
+*/
+void Source::reindex(size_t chunk) {
+    constexpr auto kLeadIn = 8 * decltype(_onsets)::kHop;
+    auto from = chunk * kChunkLength;
+    auto to = std::min(from + kChunkLength, _buffer_length);
+    auto before = from > 0 ? from - 1 : _buffer_length - 1;
+    auto lead_in = from >= kLeadIn ? level(from - kLeadIn, from).rms : 0.f;
+    //Onset energy is per hop and both channels, level is per frame and channel.
+    _onsets.begin(2.f * lead_in * lead_in * decltype(_onsets)::kHop);
+    _levels.begin();
+    _crossings.begin(_buffer[0][before] + _buffer[1][before]);
+    for (auto f = from; f < to; f++) {
+        _onsets.write(f, _buffer[0][f], _buffer[1][f]);
+        _levels.write(f, _buffer[0][f], _buffer[1][f]);
+        _crossings.write(f, _buffer[0][f], _buffer[1][f]);
+    }
 }
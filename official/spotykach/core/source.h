@@ -1,6 +1,11 @@
 #pragma once
 
 #include "i.source.h"
+#include "onset.index.h"
+#include "peak.pyramid.h"
+#include "zero.cross.index.h"
+#include "page.history.h"
+#include "globals.h"
 
 namespace blptls {
 namespace spotykach {
@@ -10,12 +15,16 @@ public:
     Source();
     void set_frozen(bool) override;
     bool is_frozen() override { return _rec_env_pos_inc != 1; }
+    bool is_idle() override { return _rec_env_pos_inc != 1 && _rec_env_pos == 0; }
 
     void set_antifreeze(bool) override;
     
     void set_cycle_start(size_t) override;
 
+    //Without undo memory, takes can't be undone.
     void initialize() override;
+    //Slots of a bank share the undo memory, see SourceBank.
+    void initialize(float* history0, float* history1);
     
     size_t length() override { return _buffer_length; };
 
@@ -25,11 +34,40 @@ public:
     size_t read_head() override { return _read_head; };
     
     void read(float&, float&, size_t) override;
+
+    size_t nearest_onset(size_t frame, size_t tolerance) override { return _onsets.nearest(frame, tolerance); }
+
+    SignalLevel level(size_t from, size_t to) override;
+
+    size_t nearest_zero_crossing(size_t frame, size_t tolerance) override;
     
     void reset() override;
+
+    void sweep() override;
+
+    bool undo() override;
+    bool redo() override;
+    bool is_restoring() override { return _history.is_swapping(); }
+
+    void clear_history() { _history.clear(); }
     
 private:
-    static constexpr size_t kFadeLength = 600;
+    static constexpr size_t kFadeLength = frames_at_48k(600);
+    static constexpr size_t kChunkLength = PeakPyramid<0>::kHop * PeakPyramid<0>::kFan;
+    static constexpr size_t kChunksCount = (kSourceBufferLength + kChunkLength - 1) / kChunkLength;
+
+    //Undo pages are the chunks, see Buffers.
+    static constexpr size_t kHistoryPages = kUndoSources * kChunksCount;
+
+    //Frames of the next chunk made ready per frame recorded, it's ready halfway through this one.
+    static constexpr size_t kPrepareFrames = 2;
+    static constexpr size_t kNoChunk = SIZE_MAX;
+
+    bool is_cleared(size_t chunk) { return _chunk_epochs[chunk] == _epoch; }
+    void clear_chunk(size_t chunk);
+    bool prepare(size_t chunk, size_t frames);
+    void reindex(size_t chunk);
+    void scan_crossings(size_t block, size_t frame, size_t& nearest, size_t& distance);
 
     float* _buffer[2];
     size_t _buffer_length;
@@ -41,6 +79,20 @@ private:
     int32_t _rec_env_pos_inc;
 
     bool _antifreeze;
+    bool _is_take_pending;
+
+    OnsetIndex<kSourceBufferLength> _onsets;
+    PeakPyramid<kSourceBufferLength> _levels;
+    ZeroCrossIndex<kSourceBufferLength> _crossings;
+
+    PageHistory<kSourceBufferLength, kChunkLength, kHistoryPages, kUndoDepth> _history;
+
+    std::array<uint16_t, kChunksCount> _chunk_epochs;
+    uint16_t _epoch;
+    size_t _sweep_chunk;
+    bool _sweep_skipped;
+    size_t _clearing;
+    size_t _cleared;
 };
 
 }
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "bit.index.h"
+
+namespace blptls {
+namespace spotykach {
+
+/*
+Coarse zero crossing index of the recorded signal.
+One bit per kBlock frames tells whether the mono sum changes
+sign inside the block. The exact frame is then found by
+reading only the blocks with a crossing, see Source::nearest_zero_crossing.
+*/
+template <size_t kLength>
+class ZeroCrossIndex {
+public:
+    static constexpr size_t kBlock = 16;
+    static constexpr size_t kNone = SIZE_MAX;
+
+    ZeroCrossIndex() { reset(); }
+
+    void reset() {
+        _bits.reset();
+        _last = 0;
+        _crossed = false;
+    }
+
+    //Starts over at a block, last is the mono sum of the frame before it.
+    void begin(float last) {
+        _last = last;
+        _crossed = false;
+    }
+
+    inline void write(size_t frame, float in0, float in1) {
+        auto value = in0 + in1;
+        _crossed |= (value >= 0) != (_last >= 0);
+        _last = value;
+        if ((frame & (kBlock - 1)) == kBlock - 1) {
+            _bits.set(frame / kBlock, _crossed);
+            _crossed = false;
+        }
+    }
+
+    //Whether the sign changes at a frame of the block, from the frame before it.
+    bool crossed(size_t block) const { return _bits.test(block); }
+
+private:
+    BitIndex<(kLength + kBlock - 1) / kBlock> _bits;
+    float _last;
+    bool _crossed;
+};
+
+}
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "mi/fx_engine.h"
+#include "../core/access.trace.h"
+
+namespace blptls {
+namespace spotykach {
+
+#ifdef SPOTYKACH_ACCESS_TRACE
+
+/*
+FxEngine reporting its delay memory accesses, see core/access.trace.h.
+It keeps copies of the engine's write pointer and LFOs in step with it
+to work out the addresses, so the Mutable Instruments code stays as it is.
+*/
+template<size_t size, clouds::Format format>
+class TracedFxEngine: public clouds::FxEngine<size, format> {
+    using Base = clouds::FxEngine<size, format>;
+
+public:
+    using T = typename Base::T;
+
+    class Context: public Base::Context {
+        using BaseContext = typename Base::Context;
+        friend class TracedFxEngine;
+
+    public:
+        Context() = default;
+
+        using BaseContext::Read;
+        using BaseContext::Write;
+
+        template<typename D>
+        inline void Read(D& d, int32_t offset, float scale) {
+            trace<D>(offset == -1 ? D::length - 1 : offset, false);
+            BaseContext::Read(d, offset, scale);
+        }
+
+        template<typename D>
+        inline void Read(D& d, float scale) {
+            Read(d, 0, scale);
+        }
+
+        template<typename D>
+        inline void Write(D& d, int32_t offset, float scale) {
+            trace<D>(offset == -1 ? D::length - 1 : offset, true);
+            BaseContext::Write(d, offset, scale);
+        }
+
+        template<typename D>
+        inline void Write(D& d, float scale) {
+            Write(d, 0, scale);
+        }
+
+        template<typename D>
+        inline void WriteAllPass(D& d, int32_t offset, float scale) {
+            trace<D>(offset == -1 ? D::length - 1 : offset, true);
+            BaseContext::WriteAllPass(d, offset, scale);
+        }
+
+        template<typename D>
+        inline void WriteAllPass(D& d, float scale) {
+            WriteAllPass(d, 0, scale);
+        }
+
+        template<typename D>
+        inline void Interpolate(D& d, float offset, float scale) {
+            trace_pair<D>(offset);
+            BaseContext::Interpolate(d, offset, scale);
+        }
+
+        template<typename D>
+        inline void Interpolate(D& d, float offset, clouds::LFOIndex index, float amplitude, float scale) {
+            trace_pair<D>(offset + amplitude * _lfo_value[index]);
+            BaseContext::Interpolate(d, offset, index, amplitude, scale);
+        }
+
+    private:
+        template<typename D>
+        inline void trace(int32_t offset, bool write) {
+            auto cell = &_buffer[(_write_ptr + D::base + offset) & (size - 1)];
+            if (write) TRACE_WRITE(FxEngine, cell);
+            else TRACE_READ(FxEngine, cell);
+        }
+
+        template<typename D>
+        inline void trace_pair(float offset) {
+            auto integral = static_cast<int32_t>(offset);
+            trace<D>(integral, false);
+            trace<D>(integral + 1, false);
+        }
+
+        T* _buffer;
+        int32_t _write_ptr;
+        float _lfo_value[2];
+    };
+
+    void Init(T* buffer) {
+        Base::Init(buffer);
+        _buffer = buffer;
+        _write_ptr = 0;
+    }
+
+    void Clear() {
+        Base::Clear();
+        _write_ptr = 0;
+    }
+
+    inline void SetLFOFrequency(clouds::LFOIndex index, float frequency) {
+        Base::SetLFOFrequency(index, frequency);
+        _lfo[index].template Init<stmlib::COSINE_OSCILLATOR_APPROXIMATE>(frequency * 32.0f);
+    }
+
+    inline void Start(Context* c) {
+        Base::Start(c);
+        if (--_write_ptr < 0) _write_ptr += size;
+        c->_buffer = _buffer;
+        c->_write_ptr = _write_ptr;
+        auto next = (_write_ptr & 31) == 0;
+        for (size_t i = 0; i < 2; i++) c->_lfo_value[i] = next ? _lfo[i].Next() : _lfo[i].value();
+    }
+
+private:
+    T* _buffer;
+    int32_t _write_ptr;
+    stmlib::CosineOscillator _lfo[2];
+};
+
+template<size_t size, clouds::Format format>
+using FxEngine = TracedFxEngine<size, format>;
+
+#else
+
+template<size_t size, clouds::Format format>
+using FxEngine = clouds::FxEngine<size, format>;
+
+#endif
+
+}
+}
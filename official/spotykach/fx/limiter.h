@@ -0,0 +1,111 @@
+#pragma once
+
+#include <array>
+#include <math.h>
+#include <stddef.h>
+#include "../core/globals.h"
+
+namespace blptls {
+namespace spotykach {
+
+/*
+Output stage counters, read them with the debugger.
+bypassed_blocks - blocks below the knee, only delayed.
+*/
+struct LimiterStats {
+    uint32_t blocks;
+    uint32_t bypassed_blocks;
+    uint32_t limited_blocks;
+    float min_gain;
+};
+
+/*
+Stereo-linked lookahead peak limiter followed by a soft knee clipper,
+working on whole audio blocks. The signal is delayed by kLookahead frames.
+The gain is set once per block from the peak of everything in the delay
+plus the incoming block, and ramps linearly across the block, so it
+is down before a peak comes out and never overshoots the ceiling.
+It recovers with a 100 ms release. The clipper bends everything above
+the knee into the range up to full scale: y = k + (1 - k)(2d - d^2),
+d = (|x| - k) / 2(1 - k), keeping the slope continuous on both ends.
+Blocks below the knee while the gain is at unity are only delayed.
+*/
+class Limiter {
+public:
+    static constexpr size_t kLookaheadBlocks = (frames_at_48k(32) + kBufferSize - 1) / kBufferSize;
+    static constexpr size_t kLookahead = (kLookaheadBlocks > 0 ? kLookaheadBlocks : 1) * kBufferSize;
+
+    Limiter() = default;
+    ~Limiter() = default;
+
+    void process(float* out0, float* out1, size_t frames) {
+        _stats.blocks++;
+        float peak = 0;
+        for (size_t f = 0; f < frames; f++) peak = fmaxf(peak, fmaxf(fabsf(out0[f]), fabsf(out1[f])));
+        _peaks[_peak_pos] = peak;
+        _peak_pos = (_peak_pos + 1) % kPeaks;
+        float held = 0;
+        for (auto p: _peaks) held = fmaxf(held, p);
+
+        auto target = held > kCeiling ? kCeiling / held : 1.f;
+        if (target > _gain) target = _gain + (target - _gain) * _release;
+        if (target > 1.f - kUnity) target = 1;
+
+        if (held <= kKnee && _gain == 1 && target == 1) {
+            _stats.bypassed_blocks++;
+            for (size_t f = 0; f < frames; f++) {
+                delay(out0[f], out1[f]);
+            }
+            return;
+        }
+
+        if (target < 1) _stats.limited_blocks++;
+        if (target < _stats.min_gain) _stats.min_gain = target;
+        auto step = (target - _gain) / frames;
+        for (size_t f = 0; f < frames; f++) {
+            delay(out0[f], out1[f]);
+            auto gain = _gain + step * (f + 1);
+            out0[f] = clip(out0[f] * gain);
+            out1[f] = clip(out1[f] * gain);
+        }
+        _gain = target;
+    }
+
+    const LimiterStats& stats() const { return _stats; }
+
+private:
+    static constexpr size_t kPeaks = kLookahead / kBufferSize + 1;
+    static constexpr float kCeiling = 1.f;
+    static constexpr float kKnee = 0.8f;
+    static constexpr float kUnity = 1e-3f;
+    static constexpr float kReleaseSeconds = 0.1f;
+
+    inline void delay(float& s0, float& s1) {
+        auto d0 = _delay[0][_pos];
+        auto d1 = _delay[1][_pos];
+        _delay[0][_pos] = s0;
+        _delay[1][_pos] = s1;
+        if (++_pos == kLookahead) _pos = 0;
+        s0 = d0;
+        s1 = d1;
+    }
+
+    static inline float clip(float x) {
+        auto a = fabsf(x);
+        if (a <= kKnee) return x;
+        auto d = fminf((a - kKnee) / (2.f * (1.f - kKnee)), 1.f);
+        auto y = kKnee + (1.f - kKnee) * (2.f * d - d * d);
+        return x > 0 ? y : -y;
+    }
+
+    std::array<std::array<float, kLookahead>, kChannelsCount> _delay {};
+    std::array<float, kPeaks> _peaks {};
+    size_t _pos = 0;
+    size_t _peak_pos = 0;
+    float _gain = 1;
+    const float _release { 1.f - expf(-static_cast<float>(kBufferSize) / (kReleaseSeconds * kSampleRate)) };
+    LimiterStats _stats { 0, 0, 0, 1 };
+};
+
+}
+}
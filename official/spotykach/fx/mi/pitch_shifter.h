@@ -36,12 +36,16 @@
 
 namespace clouds {
 
+template<Format format = FORMAT_16_BIT, typename Engine = FxEngine<4096, format> >
 class PitchShifter {
  public:
+  typedef Engine E;
+  typedef typename E::T T;
+
   PitchShifter() { }
   ~PitchShifter() { }
   
-  void Init(uint16_t* buffer) {
+  void Init(T* buffer) {
     engine_.Init(buffer);
     phase_ = 0;
     size_ = 2047.0f;
@@ -59,10 +63,10 @@ class PitchShifter {
   }
   
   void ProcessFrame(FloatFrame* input_output) {
-    typedef E::Reserve<2047, E::Reserve<2047> > Memory;
-    E::DelayLine<Memory, 0> left;
-    E::DelayLine<Memory, 1> right;
-    E::Context c;
+    typedef typename E::template Reserve<2047, typename E::template Reserve<2047> > Memory;
+    typename E::template DelayLine<Memory, 0> left;
+    typename E::template DelayLine<Memory, 1> right;
+    typename E::Context c;
     engine_.Start(&c);
     
     phase_ += (1.0f - ratio_) / size_;
@@ -102,7 +106,6 @@ class PitchShifter {
   }
   
  private:
-  typedef FxEngine<4096, FORMAT_16_BIT> E;
   E engine_;
   float phase_;
   float ratio_;
@@ -2,59 +2,111 @@
 
 #include "daisy_seed.h"
 #include "../common/fcomp.h"
+#include "fx.engine.h"
 #include "mi/pitch_shifter.h"
 #include "mi/units.h"
 #include "../core/buffers.h"
+#include "../core/ramp.h"
 
 namespace blptls {
 namespace spotykach {
 
+template <clouds::Format format>
 class PitchShift {
 public:
+    using Shifter = clouds::PitchShifter<format, FxEngine<4096, format>>;
+    using Cell = typename Shifter::T;
+
     PitchShift() = default;
     ~PitchShift() = default;
 
-    void initialize(float const sr, float const delay) {
-        ps_.Init(Buffers::pool().pitch_buf());
+    void initialize(Cell* buffer) {
+        ps_.Init(buffer);
         ps_.set_ratio(stmlib::SemitonesToRatio(0));
 	    ps_.set_size(1.0);
     }
 
     void setShift(float s) {
-        if (s > 1.0) s = 1.0;
-        if (s < 0) s = 0;
+        _ratio.jump(ratio(s));
+        _is_shifted = !is_bypassed(s);
+        _wet.jump(_is_shifted ? 1 : 0);
+        _warmup = 0;
+    }
 
-        float semitones = 0;
-        if (fcomp(s, 0.5)) {
-            _bypass = true;
-        }
-        else if (s < 0.5) {
-            semitones = 48.0 * (s - 0.5);
-            _bypass = false;
+    //Glides to the new ratio, begin_block() has to be called every block.
+    //The centre bypasses the shifter, it's crossfaded in and out.
+    void rampShift(float s) {
+        _ratio.set(ratio(s));
+        _is_shifted = !is_bypassed(s);
+    }
+
+    /*
+    A bypassed shifter's delay line is stale. Leaving the bypass,
+    it runs unheard till the grains read only new frames, then fades in.
+    */
+    void begin_block(size_t frames) {
+        _ratio.begin_block(frames);
+        if (!_is_shifted) {
+            _wet.set(0);
+            _warmup = kWarmupFrames;
         }
-        else {
-            semitones = 24.0 * (s - 0.5);
-            _bypass = false;
+        else if (_warmup == 0) {
+            _wet.set(1);
         }
-        ps_.set_ratio(stmlib::SemitonesToRatio(semitones));
+        _wet.begin_block(frames);
     }
 
     void process(float *in_out_0, float *in_out_1) {
-        if (_bypass) return;
+        auto wet = _wet.next();
+        auto is_warming_up = _is_shifted && _warmup > 0;
+        if (wet <= 0 && !is_warming_up) return;
+        if (is_warming_up) _warmup--;
 
+        ps_.set_ratio(_ratio.next());
         clouds::FloatFrame f;
         f.l = *in_out_0;
         f.r = *in_out_1;
 
         ps_.ProcessFrame(&f);
-        *in_out_0 = f.l;
-        *in_out_1 = f.r;
+        *in_out_0 += (f.l - *in_out_0) * wet;
+        *in_out_1 += (f.r - *in_out_1) * wet;
     }
 
 private:
-    clouds::PitchShifter ps_;
-    bool _bypass = true;
+    static bool is_bypassed(float s) {
+        return fcomp(s, 0.5);
+    }
+
+    static float ratio(float s) {
+        if (s > 1.0) s = 1.0;
+        if (s < 0) s = 0;
+
+        float semitones = 0;
+        if (is_bypassed(s)) {
+            semitones = 0;
+        }
+        else if (s < 0.5) {
+            semitones = 48.0 * (s - 0.5);
+        }
+        else {
+            semitones = 24.0 * (s - 0.5);
+        }
+        return stmlib::SemitonesToRatio(semitones);
+    }
+
+    //The grains read up to 2047 frames back.
+    static constexpr size_t kWarmupFrames = 2048;
+
+    Shifter ps_;
+    Ramp _ratio { 1 };
+    //Share of the shifted signal, 0 is the bypass.
+    Ramp _wet { 0 };
+    bool _is_shifted = false;
+    size_t _warmup = 0;
 };
 
+using SlicePitchShift = PitchShift<kSlicePitchFormat>;
+using ContinualPitchShift = PitchShift<kContinualPitchFormat>;
+
 }
 }
@@ -0,0 +1,192 @@
+#pragma once
+
+#include "fx.engine.h"
+#include "../core/globals.h"
+
+namespace blptls {
+namespace spotykach {
+
+//Clouds delay lengths, tuned at 32 kHz, at the current sample rate.
+static constexpr int32_t at_32k(int32_t frames) {
+    return static_cast<int32_t>(static_cast<int64_t>(frames) * kSampleRate / 32000);
+}
+
+/*
+Post mix diffuser and reverb after Clouds: four allpasses per channel
+smear the mix, then the mono sum goes through Clouds' reverb,
+four input allpasses and two cross-coupled loops. All the delay lines
+share one 16-bit FxEngine memory, laid out by a single Reserve chain.
+Clouds runs at 32 kHz, the lengths are scaled to keep its timing.
+The wet amount glides per block. Once it's down to zero the reverb
+keeps running without input till its tail has died out and then
+isn't processed at all, so a bypassed rack costs nothing
+and doesn't bring back an old tail when turned on again.
+*/
+class Reverb {
+public:
+    using E = FxEngine<kReverbMemorySize, clouds::FORMAT_16_BIT>;
+    using Cell = E::T;
+
+    Reverb() = default;
+    ~Reverb() = default;
+
+    void initialize(Cell* buffer) {
+        _engine.Init(buffer);
+        _engine.SetLFOFrequency(clouds::LFO_1, 0.5f / kSampleRate);
+        _engine.SetLFOFrequency(clouds::LFO_2, 0.3f / kSampleRate);
+    }
+
+    //Dry/wet, 0...1
+    void set_amount(float value) { _target = value; }
+
+    bool is_active() const { return _tail_frames > 0; }
+
+    void process(float* out0, float* out1, size_t frames) {
+        if (_target > 0) _tail_frames = kTailFrames;
+        if (_tail_frames == 0) return;
+        _tail_frames = _tail_frames > frames ? _tail_frames - frames : 0;
+
+        auto amount = _amount;
+        _amount += (_target - _amount) * kGlide;
+        if (_amount < kSilent) _amount = 0;
+        auto step = (_amount - amount) / frames;
+        auto input_gain = _target > 0 ? kInputGain : 0.f;
+
+        for (size_t f = 0; f < frames; f++) {
+            amount += step;
+            float l = out0[f];
+            float r = out1[f];
+            process(l, r, input_gain);
+            out0[f] += (l - out0[f]) * amount;
+            out1[f] += (r - out1[f]) * amount;
+        }
+    }
+
+private:
+    using Memory =
+        E::Reserve<at_32k(126),
+        E::Reserve<at_32k(180),
+        E::Reserve<at_32k(269),
+        E::Reserve<at_32k(444),
+        E::Reserve<at_32k(151),
+        E::Reserve<at_32k(205),
+        E::Reserve<at_32k(245),
+        E::Reserve<at_32k(405),
+        E::Reserve<at_32k(150),
+        E::Reserve<at_32k(214),
+        E::Reserve<at_32k(319),
+        E::Reserve<at_32k(527),
+        E::Reserve<at_32k(2182),
+        E::Reserve<at_32k(2690),
+        E::Reserve<at_32k(4501),
+        E::Reserve<at_32k(2525),
+        E::Reserve<at_32k(2197),
+        E::Reserve<at_32k(6312)> > > > > > > > > > > > > > > > > >;
+
+    static constexpr float kDiffusion = 0.625f;
+    static constexpr float kTime = 0.7f;
+    static constexpr float kLp = 0.7f;
+    static constexpr float kInputGain = 0.2f;
+    static constexpr float kGlide = 0.01f;
+    static constexpr float kSilent = 1e-3f;
+    static constexpr size_t kTailFrames = 5 * kSampleRate;
+
+    //One frame of the wet signal, l and r are replaced.
+    inline void process(float& l, float& r, float input_gain) {
+        E::DelayLine<Memory, 0> dl1;
+        E::DelayLine<Memory, 1> dl2;
+        E::DelayLine<Memory, 2> dl3;
+        E::DelayLine<Memory, 3> dl4;
+        E::DelayLine<Memory, 4> dr1;
+        E::DelayLine<Memory, 5> dr2;
+        E::DelayLine<Memory, 6> dr3;
+        E::DelayLine<Memory, 7> dr4;
+        E::DelayLine<Memory, 8> ap1;
+        E::DelayLine<Memory, 9> ap2;
+        E::DelayLine<Memory, 10> ap3;
+        E::DelayLine<Memory, 11> ap4;
+        E::DelayLine<Memory, 12> dap1a;
+        E::DelayLine<Memory, 13> dap1b;
+        E::DelayLine<Memory, 14> del1;
+        E::DelayLine<Memory, 15> dap2a;
+        E::DelayLine<Memory, 16> dap2b;
+        E::DelayLine<Memory, 17> del2;
+        E::Context c;
+        _engine.Start(&c);
+
+        const float kap = kDiffusion;
+        float diffused_l;
+        float diffused_r;
+        float apout;
+
+        c.Read(l);
+        c.Read(dl1 TAIL, kap);
+        c.WriteAllPass(dl1, -kap);
+        c.Read(dl2 TAIL, kap);
+        c.WriteAllPass(dl2, -kap);
+        c.Read(dl3 TAIL, kap);
+        c.WriteAllPass(dl3, -kap);
+        c.Read(dl4 TAIL, kap);
+        c.WriteAllPass(dl4, -kap);
+        c.Write(diffused_l, 0.0f);
+
+        c.Read(r);
+        c.Read(dr1 TAIL, kap);
+        c.WriteAllPass(dr1, -kap);
+        c.Read(dr2 TAIL, kap);
+        c.WriteAllPass(dr2, -kap);
+        c.Read(dr3 TAIL, kap);
+        c.WriteAllPass(dr3, -kap);
+        c.Read(dr4 TAIL, kap);
+        c.WriteAllPass(dr4, -kap);
+        c.Write(diffused_r, 0.0f);
+
+        //Smear AP1 inside the loop.
+        c.Interpolate(ap1, at_32k(10), clouds::LFO_1, at_32k(60), 1.0f);
+        c.Write(ap1, at_32k(100), 0.0f);
+
+        c.Read(diffused_l + diffused_r, input_gain);
+        c.Read(ap1 TAIL, kap);
+        c.WriteAllPass(ap1, -kap);
+        c.Read(ap2 TAIL, kap);
+        c.WriteAllPass(ap2, -kap);
+        c.Read(ap3 TAIL, kap);
+        c.WriteAllPass(ap3, -kap);
+        c.Read(ap4 TAIL, kap);
+        c.WriteAllPass(ap4, -kap);
+        c.Write(apout);
+
+        c.Load(apout);
+        c.Interpolate(del2, at_32k(6211), clouds::LFO_2, at_32k(100), kTime);
+        c.Lp(_lp_1, kLp);
+        c.Read(dap1a TAIL, -kap);
+        c.WriteAllPass(dap1a, kap);
+        c.Read(dap1b TAIL, kap);
+        c.WriteAllPass(dap1b, -kap);
+        c.Write(del1, 2.0f);
+        c.Write(l, 0.0f);
+
+        c.Load(apout);
+        c.Read(del1 TAIL, kTime);
+        c.Lp(_lp_2, kLp);
+        c.Read(dap2a TAIL, kap);
+        c.WriteAllPass(dap2a, -kap);
+        c.Read(dap2b TAIL, -kap);
+        c.WriteAllPass(dap2b, kap);
+        c.Write(del2, 2.0f);
+        c.Write(r, 0.0f);
+
+        l += diffused_l;
+        r += diffused_r;
+    }
+
+    E _engine;
+    float _lp_1 = 0;
+    float _lp_2 = 0;
+    float _amount = 0;
+    float _target = 0;
+    size_t _tail_frames = 0;
+};
+
+}
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <stddef.h>
+#include <math.h>
+#include <algorithm>
+#if defined(__arm__)
+#include "arm_math.h"
+#endif
+
+namespace blptls {
+namespace spotykach {
+
+/*
+Real FFT of kSize points. Spectra are packed the way arm_rfft_fast_f32 packs them:
+re[0], re[kSize / 2], re[1], im[1], ... re[kSize / 2 - 1], im[kSize / 2 - 1].
+The inverse is scaled by 1 / kSize. Inputs are used as scratch.
+CMSIS on the target, a plain radix-2 transform elsewhere.
+*/
+template <size_t kSize>
+class RealFFT {
+public:
+    static_assert((kSize & (kSize - 1)) == 0, "FFT size should be a power of two");
+
+    void initialize() {
+#if defined(__arm__)
+        arm_rfft_fast_init_f32(&_instance, kSize);
+#else
+        for (size_t i = 0; i < kSize / 2; i++) {
+            _cos[i] = cosf(2.f * M_PI * i / kSize);
+            _sin[i] = sinf(2.f * M_PI * i / kSize);
+        }
+#endif
+    }
+
+    void forward(float* in, float* out) {
+#if defined(__arm__)
+        arm_rfft_fast_f32(&_instance, in, out, 0);
+#else
+        for (size_t i = 0; i < kSize; i++) {
+            _re[i] = in[i];
+            _im[i] = 0;
+        }
+        transform(false);
+        out[0] = _re[0];
+        out[1] = _re[kSize / 2];
+        for (size_t k = 1; k < kSize / 2; k++) {
+            out[2 * k] = _re[k];
+            out[2 * k + 1] = _im[k];
+        }
+#endif
+    }
+
+    void inverse(float* in, float* out) {
+#if defined(__arm__)
+        arm_rfft_fast_f32(&_instance, in, out, 1);
+#else
+        _re[0] = in[0];
+        _im[0] = 0;
+        _re[kSize / 2] = in[1];
+        _im[kSize / 2] = 0;
+        for (size_t k = 1; k < kSize / 2; k++) {
+            _re[k] = in[2 * k];
+            _im[k] = in[2 * k + 1];
+            _re[kSize - k] = in[2 * k];
+            _im[kSize - k] = -in[2 * k + 1];
+        }
+        transform(true);
+        for (size_t i = 0; i < kSize; i++) out[i] = _re[i] / kSize;
+#endif
+    }
+
+private:
+#if defined(__arm__)
+    arm_rfft_fast_instance_f32 _instance;
+#else
+    void transform(bool inverse) {
+        for (size_t i = 1, j = 0; i < kSize; i++) {
+            size_t bit = kSize >> 1;
+            for (; j & bit; bit >>= 1) j ^= bit;
+            j ^= bit;
+            if (i < j) {
+                std::swap(_re[i], _re[j]);
+                std::swap(_im[i], _im[j]);
+            }
+        }
+        for (size_t len = 2; len <= kSize; len <<= 1) {
+            auto step = kSize / len;
+            for (size_t i = 0; i < kSize; i += len) {
+                for (size_t k = 0; k < len / 2; k++) {
+                    auto c = _cos[k * step];
+                    auto s = inverse ? _sin[k * step] : -_sin[k * step];
+                    auto a = i + k;
+                    auto b = a + len / 2;
+                    auto re = _re[b] * c - _im[b] * s;
+                    auto im = _re[b] * s + _im[b] * c;
+                    _re[b] = _re[a] - re;
+                    _im[b] = _im[a] - im;
+                    _re[a] += re;
+                    _im[a] += im;
+                }
+            }
+        }
+    }
+
+    float _cos[kSize / 2];
+    float _sin[kSize / 2];
+    float _re[kSize];
+    float _im[kSize];
+#endif
+};
+
+}
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+#include "rfft.h"
+#include "../core/i.source.h"
+
+namespace blptls {
+namespace spotykach {
+
+/*
+Spectral freeze. A windowed snapshot of the source is taken
+at a given frame, its magnitudes are resynthesized every hop
+with random phases and overlap-added with 75% overlap.
+The work of a hop is split into kStages stages run evenly
+through the hop, so no single frame carries a whole FFT plus the rest.
+A frame still carries a whole inverse FFT, CMSIS can't split one.
+At kSpectralSize 1024 that worst frame takes 13 to 17 us with the host's
+portable FFT, see host/bench/spectral.freeze.
+*/
+template <size_t kSize>
+class SpectralFreeze {
+public:
+    static constexpr size_t kHop = kSize / 4;
+    static constexpr size_t kStages = 8;
+
+    void initialize() {
+        _fft.initialize();
+        for (size_t i = 0; i < kSize; i++) _window[i] = 0.5f - 0.5f * cosf(2.f * M_PI * i / kSize);
+        for (size_t i = 0; i < kPhases; i++) _cos[i] = cosf(2.f * M_PI * i / kPhases);
+        std::fill(_magnitudes, _magnitudes + kBins, 0.f);
+        std::fill(_ola, _ola + kRing, 0.f);
+    }
+
+    //Fades in from silence, on disable the last frames fade out.
+    void set_enabled(bool value) {
+        if (value == _is_enabled) return;
+        _is_enabled = value;
+        if (!value) _tail = kRing;
+        _hop_start = _read;
+        _hop_frame = 0;
+    }
+
+    bool is_enabled() const { return _is_enabled; }
+    bool is_active() const { return _is_enabled || _tail > 0; }
+
+    //The snapshot is taken at the next hop, centered on the frame.
+    void capture(size_t frame) {
+        _capture_frame = frame;
+        _capture_pending = true;
+    }
+
+    float process(ISource& source) {
+        auto out = _ola[_read];
+        _ola[_read] = 0;
+        _read = (_read + 1) & (kRing - 1);
+        if (!_is_enabled) {
+            if (_tail > 0) _tail--;
+            return out;
+        }
+        if (_hop_frame % (kHop / kStages) == 0) run_stage(_hop_frame / (kHop / kStages), source);
+        if (++_hop_frame == kHop) {
+            _hop_frame = 0;
+            _hop_start = (_hop_start + kHop) & (kRing - 1);
+        }
+        return out;
+    }
+
+private:
+    static constexpr size_t kBins = kSize / 2 + 1;
+    static constexpr size_t kRing = 2 * kSize;
+    static constexpr size_t kPhases = 256;
+    static constexpr float kGain = 4.f / 3.f;
+
+    void run_stage(size_t stage, ISource& source) {
+        switch (stage) {
+            case 0: if (_capture_pending) take_snapshot(source); break;
+            case 1: if (_is_captured) _fft.forward(_time, _spectrum); break;
+            case 2: if (_is_captured) update_magnitudes(); break;
+            case 3: randomize_phases(); break;
+            case 4: _fft.inverse(_spectrum, _time); break;
+            case 5: overlap_add(); break;
+            default: break;
+        }
+    }
+
+    void take_snapshot(ISource& source) {
+        _capture_pending = false;
+        auto start = _capture_frame + source.length() - kSize / 2;
+        for (size_t i = 0; i < kSize; i++) {
+            float l, r;
+            source.read(l, r, start + i);
+            _time[i] = 0.5f * (l + r) * _window[i];
+        }
+        _is_captured = true;
+    }
+
+    void update_magnitudes() {
+        _is_captured = false;
+        _magnitudes[0] = fabsf(_spectrum[0]);
+        _magnitudes[kBins - 1] = fabsf(_spectrum[1]);
+        for (size_t k = 1; k < kBins - 1; k++) {
+            auto re = _spectrum[2 * k];
+            auto im = _spectrum[2 * k + 1];
+            _magnitudes[k] = sqrtf(re * re + im * im);
+        }
+    }
+
+    //sin(x) is cos(x - pi / 2), a quarter of the table back.
+    //Nyquist is real, its phase is 0 or pi.
+    void randomize_phases() {
+        _spectrum[0] = _magnitudes[0];
+        for (size_t k = 1; k < kBins - 1; k++) {
+            _random ^= _random << 13;
+            _random ^= _random >> 17;
+            _random ^= _random << 5;
+            auto phase = _random & (kPhases - 1);
+            _spectrum[2 * k] = _magnitudes[k] * _cos[phase];
+            _spectrum[2 * k + 1] = _magnitudes[k] * _cos[(phase + 3 * kPhases / 4) & (kPhases - 1)];
+        }
+        _spectrum[1] = _random & kPhases ? -_magnitudes[kBins - 1] : _magnitudes[kBins - 1];
+    }
+
+    /*
+    The frame starts with the next hop. Frames with random phases add up
+    in power: analysis and synthesis Hann windows at 75% overlap
+    leave 9 / 16 of it, so the gain is 4 / 3.
+    */
+    void overlap_add() {
+        auto start = _hop_start + kHop;
+        for (size_t i = 0; i < kSize; i++) _ola[(start + i) & (kRing - 1)] += kGain * _time[i] * _window[i];
+    }
+
+    RealFFT<kSize> _fft;
+    float _window[kSize];
+    float _cos[kPhases];
+    float _time[kSize];
+    float _spectrum[kSize];
+    float _magnitudes[kBins];
+    float _ola[kRing];
+
+    bool _is_enabled = false;
+    size_t _tail = 0;
+    volatile bool _capture_pending = false;
+    volatile size_t _capture_frame = 0;
+    bool _is_captured = false;
+    size_t _read = 0;
+    size_t _hop_start = 0;
+    size_t _hop_frame = 0;
+    uint32_t _random = 0x9e3779b9;
+};
+
+}
+}
@@ -0,0 +1,62 @@
+/*
+Cost of the output limiter per audio block: quiet blocks that are only
+delayed, and hot ones that are limited and clipped, see fx/limiter.h.
+Also checks the hot output stays under full scale and the quiet one
+comes out bit exact, a lookahead later.
+*/
+
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+#include "check.h"
+#include "rig.h"
+#include "fx/limiter.h"
+
+using namespace blptls::spotykach;
+
+static constexpr size_t kBlocks = 1 << 14;
+
+static std::vector<float> signal(float gain) {
+    std::vector<float> s(kBlocks * kBufferSize);
+    for (size_t f = 0; f < s.size(); f++) s[f] = gain * host::test_loop(f) / 0.5f;
+    return s;
+}
+
+//ns per block, out gets the limited signal of the last run.
+static double run(const std::vector<float>& in, std::vector<float>& out) {
+    static Limiter limiter;
+    float l[kBufferSize], r[kBufferSize];
+    out.resize(in.size());
+    return host::nanoseconds_per_call([&](size_t b) {
+        std::copy(in.begin() + b * kBufferSize, in.begin() + (b + 1) * kBufferSize, l);
+        std::copy(l, l + kBufferSize, r);
+        limiter.process(l, r, kBufferSize);
+        std::copy(l, l + kBufferSize, out.begin() + b * kBufferSize);
+    }, kBlocks);
+}
+
+int main() {
+    std::vector<float> out;
+    auto quiet = signal(0.5f);
+    auto hot = signal(3.f);
+
+    auto copy_ns = host::nanoseconds_per_call([&](size_t b) {
+        float l[kBufferSize], r[kBufferSize];
+        std::copy(quiet.begin() + b * kBufferSize, quiet.begin() + (b + 1) * kBufferSize, l);
+        std::copy(l, l + kBufferSize, r);
+        out.resize(quiet.size());
+        std::copy(l, l + kBufferSize, out.begin() + b * kBufferSize);
+    }, kBlocks);
+
+    auto quiet_ns = run(quiet, out);
+    for (size_t f = Limiter::kLookahead; f < out.size(); f++) CHECK(out[f] == quiet[f - Limiter::kLookahead]);
+
+    auto hot_ns = run(hot, out);
+    float peak = 0;
+    for (auto v: out) peak = fmaxf(peak, fabsf(v));
+    CHECK(peak <= 1.f);
+
+    printf("limiter, %u frame blocks: quiet %.1f ns, hot %.1f ns, block copy alone %.1f ns, hot peak %.3f\n",
+        kBufferSize, quiet_ns, hot_ns, copy_ns, peak);
+    return 0;
+}
@@ -0,0 +1,46 @@
+/*
+Cost of the onset index: per recorded frame and per nearest onset lookup,
+see core/onset.index.h. Also checks the test loop's beats are found.
+*/
+
+#include <stdio.h>
+#include <vector>
+#include "check.h"
+#include "rig.h"
+#include "onset.index.h"
+
+using namespace blptls::spotykach;
+
+static OnsetIndex<kSourceBufferLength> onsets;
+static float take[kSourceBufferLength];
+
+int main() {
+    for (size_t f = 0; f < kSourceBufferLength; f++) take[f] = host::test_loop(f);
+
+    volatile float sink = 0;
+    auto copy_ns = host::nanoseconds_per_call([&](size_t f) { sink = take[f] * take[f]; }, kSourceBufferLength);
+    auto write_ns = host::nanoseconds_per_call([&](size_t f) {
+        if (f == 0) onsets.reset();
+        onsets.write(f, take[f], take[f]);
+    }, kSourceBufferLength);
+
+    const auto beat = kSampleRate / 2;
+    for (size_t b = 1; b < kSourceBufferLength / beat; b++) {
+        CHECK(onsets.nearest(b * beat, kOnsetSnapFrames) != onsets.kNone);
+    }
+    CHECK(onsets.nearest(beat / 2, kOnsetSnapFrames) == onsets.kNone);
+
+    size_t found = 0;
+    auto lookup_ns = host::nanoseconds_per_call([&](size_t i) {
+        auto frame = (i * 7919) % kSourceBufferLength;
+        found += onsets.nearest(frame, kOnsetSnapFrames) != onsets.kNone;
+    }, 1 << 20);
+    auto far_ns = host::nanoseconds_per_call([&](size_t i) {
+        auto frame = (i * 7919) % kSourceBufferLength;
+        found += onsets.nearest(frame, kSourceBufferLength) != onsets.kNone;
+    }, 1 << 20);
+
+    printf("onset index: write %.2f ns/frame (squared read alone %.2f), nearest %.1f ns, unbounded nearest %.1f ns\n",
+        write_ns, copy_ns, lookup_ns, far_ns);
+    return found > 0 ? 0 : 1;
+}
@@ -0,0 +1,89 @@
+/*
+Pitch shifter delay memory formats, see SLICE_PITCH_FORMAT in core/buffers.h:
+ns per frame, memory per shifter and the noise floor against the
+32-bit one, which keeps the delay line in float. Placement, SDRAM,
+AXI SRAM or DTCM, only tells on the target, the host has one memory.
+*/
+
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+#include "check.h"
+#include "rig.h"
+#include "fx/pitch.shift.h"
+
+using namespace blptls::spotykach;
+
+static constexpr size_t kFrames = kSampleRate;
+static constexpr size_t kLength = 4096;
+
+//Two steady partials, so the noise floor doesn't move.
+static std::vector<float> input(kFrames);
+
+struct Result {
+    double ns;
+    std::vector<float> out;
+};
+
+template <clouds::Format format>
+static Result run(float shift) {
+    using Shift = PitchShift<format>;
+    static typename Shift::Cell memory[kLength];
+    static Shift shifter;
+    Result result;
+    shifter.initialize(memory);
+    shifter.setShift(shift);
+    result.ns = host::nanoseconds_per_call([&](size_t f) {
+        float l = input[f], r = l;
+        shifter.process(&l, &r);
+    }, kFrames);
+
+    shifter.initialize(memory);
+    shifter.setShift(shift);
+    result.out.resize(kFrames);
+    for (size_t f = 0; f < kFrames; f++) {
+        float l = input[f], r = l;
+        shifter.process(&l, &r);
+        result.out[f] = l;
+    }
+    return result;
+}
+
+//Error against the reference in dB of the reference's level.
+static float noise_floor(const std::vector<float>& out, const std::vector<float>& reference) {
+    double error = 0, level = 0;
+    for (size_t f = 0; f < out.size(); f++) {
+        error += (out[f] - reference[f]) * (out[f] - reference[f]);
+        level += reference[f] * reference[f];
+    }
+    CHECK(level > 0);
+    return error > 0 ? 10.f * log10f(error / level) : -INFINITY;
+}
+
+int main() {
+    for (size_t f = 0; f < kFrames; f++) {
+        auto t = static_cast<float>(f) / kSampleRate;
+        input[f] = 0.25f * sinf(2.f * static_cast<float>(M_PI) * 220.f * t) + 0.1f * sinf(2.f * static_cast<float>(M_PI) * 1375.f * t);
+    }
+    printf("pitch shifter per frame\n");
+    printf("%-8s %-7s %8s %8s %10s\n", "shift", "format", "ns", "KB", "noise dB");
+    for (auto shift: { 0.25f, 0.75f }) {
+        auto f32 = run<clouds::FORMAT_32_BIT>(shift);
+        auto f16 = run<clouds::FORMAT_16_BIT>(shift);
+        auto f12 = run<clouds::FORMAT_12_BIT>(shift);
+        auto n16 = noise_floor(f16.out, f32.out);
+        auto n12 = noise_floor(f12.out, f32.out);
+        auto semitones = shift < 0.5f ? 48.f * (shift - 0.5f) : 24.f * (shift - 0.5f);
+        auto print = [semitones](const char* name, const Result& r, size_t cell, float noise) {
+            printf("%+5.0f st  %-7s %8.1f %8zu %10.1f\n", semitones, name, r.ns, kLength * cell / 1024, noise);
+        };
+        print("32-bit", f32, sizeof(clouds::DataType<clouds::FORMAT_32_BIT>::T), -INFINITY);
+        print("16-bit", f16, sizeof(clouds::DataType<clouds::FORMAT_16_BIT>::T), n16);
+        print("12-bit", f12, sizeof(clouds::DataType<clouds::FORMAT_12_BIT>::T), n12);
+        //16 bits in a unit range and 12 bits with 8 times the headroom.
+        CHECK(n16 < -75.f);
+        CHECK(n12 < -55.f);
+        CHECK(n16 < n12);
+    }
+    return 0;
+}
@@ -0,0 +1,64 @@
+/*
+Cost of the post mix reverb: the rack alone per frame, and the whole
+core with both engines playing, rack on and off, see fx/reverb.h.
+*/
+
+#include <stdio.h>
+#include <time.h>
+#include "check.h"
+#include "rig.h"
+
+using namespace blptls::spotykach;
+
+//The wet amount the pads toggle, see Controller.
+static constexpr float kAmount = 0.35f;
+
+static double cpu_ns() {
+    timespec t;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+//Best of a few renders, ns per frame.
+static double render_ns(host::Rig& rig, size_t frames) {
+    double best = 1e30;
+    for (int run = 0; run < 5; run++) {
+        auto start = cpu_ns();
+        rig.render(frames);
+        best = std::min(best, (cpu_ns() - start) / frames);
+    }
+    return best;
+}
+
+int main() {
+    static host::Rig rig;
+    rig.record(0, kSourceBufferLength, host::test_loop);
+    rig.record(1, kSourceBufferLength, host::test_loop);
+    rig.play();
+
+    const size_t frames = kSampleRate;
+    rig.core.set_reverb_amount(0);
+    rig.render(6 * kSampleRate);
+    auto off_ns = render_ns(rig, frames);
+
+    rig.core.set_reverb_amount(kAmount);
+    rig.render(kSampleRate);
+    auto on_ns = render_ns(rig, frames);
+
+    //The core has the pool's reverb memory, the rack alone gets its own.
+    static Reverb reverb;
+    static Reverb::Cell memory[kReverbMemorySize];
+    static float input[kSampleRate], l[kBufferSize], r[kBufferSize];
+    for (size_t f = 0; f < frames; f++) input[f] = host::test_loop(f);
+    reverb.initialize(memory);
+    reverb.set_amount(kAmount);
+    auto rack_ns = host::nanoseconds_per_call([&](size_t b) {
+        for (size_t f = 0; f < kBufferSize; f++) l[f] = r[f] = input[b * kBufferSize + f];
+        reverb.process(l, r, kBufferSize);
+    }, frames / kBufferSize) / kBufferSize;
+    CHECK(reverb.is_active());
+
+    printf("reverb: rack %.1f ns/frame, core %.1f ns/frame off, %.1f on (%+.0f%%)\n",
+        rack_ns, off_ns, on_ns, 100. * (on_ns - off_ns) / off_ns);
+    return 0;
+}
@@ -0,0 +1,64 @@
+/*
+Cost of the spectral freeze per FFT size: the average per frame and the
+worst frame, which carries a stage of the hop, see fx/spectral.freeze.h.
+kSpectralSize in core/globals.h picks the size.
+The host runs the portable FFT, not CMSIS, so compare sizes with each
+other rather than with the audio block budget.
+*/
+
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include "check.h"
+#include "rig.h"
+#include "source.h"
+#include "fx/spectral.freeze.h"
+
+using namespace blptls::spotykach;
+
+static Source source;
+
+/*
+The worst frame carries the biggest stage, an FFT. Every frame of the hop
+is timed over a few hops and the best is kept, so the host scheduler
+doesn't show up in it.
+*/
+template <size_t kSize>
+static void measure() {
+    static SpectralFreeze<kSize> freeze;
+    freeze.initialize();
+    freeze.capture(kSampleRate / 2);
+    freeze.set_enabled(true);
+
+    volatile float sink = 0;
+    auto average_ns = host::nanoseconds_per_call([&](size_t) { sink = freeze.process(source); }, 4 * kSampleRate);
+    CHECK(sink == sink);
+
+    constexpr auto kHop = SpectralFreeze<kSize>::kHop;
+    std::vector<double> best(kHop, 1e30);
+    for (size_t f = 0; f < 64 * kHop; f++) {
+        auto start = std::chrono::steady_clock::now();
+        sink = freeze.process(source);
+        std::chrono::duration<double, std::nano> d = std::chrono::steady_clock::now() - start;
+        best[f % kHop] = std::min(best[f % kHop], d.count());
+    }
+    auto worst_ns = *std::max_element(best.begin(), best.end());
+
+    printf("%5zu points: %6.1f ns/frame, worst frame %7.0f ns, %5.1f Hz bins, %5.1f ms frames\n",
+        kSize, average_ns, worst_ns, static_cast<float>(kSampleRate) / kSize, 1000.f * kSize / kSampleRate);
+}
+
+int main() {
+    source.initialize();
+    source.set_frozen(false);
+    for (size_t f = 0; f < kSampleRate; f++) source.write(host::test_loop(f), host::test_loop(f));
+    source.set_frozen(true);
+
+    measure<256>();
+    measure<512>();
+    measure<1024>();
+    measure<2048>();
+    measure<4096>();
+    return 0;
+}
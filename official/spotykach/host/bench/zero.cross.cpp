@@ -0,0 +1,36 @@
+/*
+Cost of Source::nearest_zero_crossing on a low and a high
+frequency take, see core/zero.cross.index.h.
+*/
+
+#include <stdio.h>
+#include <math.h>
+#include "check.h"
+#include "source.h"
+
+using namespace blptls::spotykach;
+
+static Source sources[2];
+
+int main() {
+    const float frequencies[] { 60.f, 5000.f };
+    for (int i = 0; i < 2; i++) {
+        auto& s = sources[i];
+        s.initialize();
+        s.set_frozen(false);
+        for (size_t f = 0; f < kSourceBufferLength; f++) {
+            auto v = sinf(2.f * static_cast<float>(M_PI) * frequencies[i] * f / kSampleRate);
+            s.write(v, v);
+        }
+        s.set_frozen(true);
+
+        size_t found = 0;
+        auto ns = host::nanoseconds_per_call([&](size_t n) {
+            auto frame = (n * 7919) % kSourceBufferLength;
+            found += s.nearest_zero_crossing(frame, kZeroCrossTolerance) != SIZE_MAX;
+        }, 1 << 20);
+        CHECK(found > 0);
+        printf("nearest zero crossing, %.0f Hz: %.1f ns, found %.0f%%\n", frequencies[i], ns, 100.f * found / (5 << 20));
+    }
+    return 0;
+}
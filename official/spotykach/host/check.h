@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+
+/*
+Host test and benchmark helpers. A failed check prints where
+and exits, so a test is a main() returning 0 and make stops at it.
+*/
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            exit(1); \
+        } \
+    } while (0)
+
+namespace host {
+
+//Nanoseconds of one call of f, the best of a few runs of n calls.
+template <typename F>
+double nanoseconds_per_call(F&& f, size_t n, int runs = 5) {
+    double best = 1e30;
+    for (int r = 0; r < runs; r++) {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < n; i++) f(i);
+        std::chrono::duration<double, std::nano> d = std::chrono::steady_clock::now() - start;
+        if (d.count() / n < best) best = d.count() / n;
+    }
+    return best;
+}
+
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <vector>
+#include <math.h>
+#include "core/core.h"
+#include "control/clock.h"
+
+namespace host {
+
+using namespace blptls::spotykach;
+
+/*
+The audio callback of spotykach.cpp without the hardware: the clock
+ticks, the core renders a block. Buffers are static, see core/buffers.h,
+so there is one rig per process.
+*/
+class Rig {
+public:
+    Rig() {
+        core.initialize();
+        clock.run(core);
+        //What the controller's first pass sets: the grid, which gives the engines
+        //the pattern step, and the knobs, here at their centre or start.
+        for (uint32_t i = 0; i < kEnginesCount; i++) {
+            auto& e = core.engineAt(i);
+            e.trig().set_grid(0);
+            e.set_slice_position(0);
+            e.set_pitch_shift(0.5);
+        }
+        _p.tempo = clock.tempo();
+        _p.sampleRate = kSampleRate;
+    }
+
+    /*
+    Renders frames, rounded up to blocks. input(frame) gives the mono input,
+    output, if given, gets the left channel.
+    */
+    template <typename Input>
+    void render(size_t frames, Input&& input, std::vector<float>* output = nullptr) {
+        float in_l[kBufferSize], in_r[kBufferSize], out_l[kBufferSize], out_r[kBufferSize];
+        const float* in[] { in_l, in_r };
+        float* out[] { out_l, out_r };
+        for (size_t done = 0; done < frames; done += kBufferSize) {
+            for (size_t f = 0; f < kBufferSize; f++) in_l[f] = in_r[f] = input(_frame + f);
+            _p.tempo = clock.tempo();
+            clock.tick();
+            core.preprocess(_p);
+            core.process(in, out, kBufferSize);
+            if (output) output->insert(output->end(), out_l, out_l + kBufferSize);
+            _frame += kBufferSize;
+        }
+    }
+
+    void render(size_t frames, std::vector<float>* output = nullptr) {
+        render(frames, [](size_t) { return 0.f; }, output);
+    }
+
+    //Records input into engine e with the clock stopped.
+    template <typename Input>
+    void record(int e, size_t frames, Input&& input) {
+        core.engineAt(e).set_frozen(false);
+        render(frames, input);
+        core.engineAt(e).set_frozen(true);
+    }
+
+    void play() { if (!clock.is_running()) clock.toggle_is_running(); }
+    void stop() { if (clock.is_running()) clock.toggle_is_running(); }
+
+    size_t frame() const { return _frame; }
+
+    Core core;
+    Clock clock;
+
+private:
+    PlaybackParameters _p;
+    size_t _frame { 0 };
+};
+
+//A decaying 110 Hz tone every quarter at 120 BPM, something with onsets.
+inline float test_loop(size_t frame) {
+    auto beat = kSampleRate / 2;
+    float t = static_cast<float>(frame % beat) / kSampleRate;
+    return 0.5f * expf(-8.f * t) * sinf(2.f * static_cast<float>(M_PI) * 110.f * frame / kSampleRate);
+}
+
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+/*
+Host stand-ins for the few parts of libDaisy the core, the effects
+and the clock use, see host/Makefile. Memory sections are plain memory,
+time is the host's steady clock, pins and the UART do nothing.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <chrono>
+
+#define DSY_SDRAM_BSS
+#define DTCM_MEM_SECTION
+#define DMA_BUFFER_MEM_SECTION
+
+namespace daisy {
+
+struct Pin {};
+
+namespace seed {
+    constexpr Pin D10 {};
+    constexpr Pin D14 {};
+}
+
+struct GPIO {
+    struct Config {
+        Pin pin;
+    };
+    void Init(const Config&) {}
+    bool Read() { return false; }
+};
+
+struct System {
+    static uint32_t GetUs() {
+        auto now = std::chrono::steady_clock::now().time_since_epoch();
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(now).count());
+    }
+    static uint32_t GetNow() { return GetUs() / 1000; }
+};
+
+struct UartHandler {
+    enum class Result { OK, ERR };
+    struct Config {
+        enum class Peripheral { USART_1 };
+        enum class Mode { RX };
+        Peripheral periph;
+        Mode mode;
+        uint32_t baudrate;
+        struct {
+            Pin tx;
+            Pin rx;
+        } pin_config;
+    };
+    typedef void (*CircularRxCallbackFunctionPtr)(uint8_t* data, size_t size, void* context, Result result);
+
+    Result Init(const Config&) { return Result::OK; }
+    Result DmaListenStart(uint8_t*, size_t, CircularRxCallbackFunctionPtr, void*) { return Result::OK; }
+};
+
+struct DaisySeed {};
+
+}
@@ -0,0 +1,3 @@
+#pragma once
+
+//SDRAM is plain memory on the host, see daisy_seed.h
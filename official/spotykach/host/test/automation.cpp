@@ -0,0 +1,85 @@
+/*
+Automation lanes loop with the pattern they're anchored to: the loop
+is whole patterns from the pattern start before the recording, and
+a pattern that starts over out of step restarts it.
+A knob swept all through the longest loop fits into its lane.
+*/
+
+#include <stdio.h>
+#include <math.h>
+#include "check.h"
+#include "control/automation.h"
+
+using namespace blptls::spotykach;
+
+static constexpr uint32_t kPatternTicks = kBeatsPerMeasure * kPPQN;
+
+static Automation automation;
+static uint32_t position;
+static uint32_t pattern_start;
+
+//A controller pass a tick later, with the knob of lane 0 at value.
+static float pass(float value) {
+    automation.advance(position, (position - pattern_start) % kPatternTicks, kPatternTicks);
+    position++;
+    auto v = automation.process(0, value);
+    for (size_t i = 1; i < Automation::kLanesCount; i++) automation.process(i, 0.f);
+    return v;
+}
+
+//The lane value at a pattern position, the knob being left where the recording stopped.
+static float at(uint32_t pattern_position) {
+    while ((position - pattern_start) % kPatternTicks != pattern_position) pass(0.f);
+    return pass(0.f);
+}
+
+//A knob swept up and down over the whole range every pattern.
+static float sweep(uint32_t tick) {
+    auto t = static_cast<float>(tick % kPatternTicks) / kPatternTicks;
+    return t < 0.5f ? 2 * t : 2 - 2 * t;
+}
+
+int main() {
+    //Recording starts a quarter into the pattern and runs a bit over a pattern:
+    //the knob is up for the second quarter of it.
+    auto quarter = kPatternTicks / 4;
+    for (uint32_t i = 0; i < quarter; i++) pass(0.f);
+    automation.toggle_recording();
+    for (uint32_t i = 0; i < kPatternTicks + 2; i++) {
+        auto t = (position - pattern_start) % kPatternTicks;
+        pass(t >= 2 * quarter && t < 3 * quarter ? 1.f : 0.f);
+    }
+    automation.toggle_recording();
+    CHECK(automation.state() == Automation::State::Playing);
+
+    //Rounded to a pattern, in step with it.
+    CHECK(at(quarter + 4) < 0.1f);
+    CHECK(at(2 * quarter + 4) > 0.9f);
+    CHECK(at(3 * quarter + 4) < 0.1f);
+    CHECK(at(2 * quarter + 4) > 0.9f);
+
+    //The pattern starts over out of step, a trigger reset: so does the loop.
+    pass(0.f);
+    pattern_start = position;
+    CHECK(at(4) < 0.1f);
+    CHECK(at(2 * quarter + 4) > 0.9f);
+    CHECK(at(3 * quarter + 4) < 0.1f);
+
+    //The longest loop from a pattern start, the recording stops by itself.
+    at(kPatternTicks - 1);
+    automation.toggle_recording();
+    auto start = position;
+    while (automation.state() == Automation::State::Recording) pass(sweep(position - start));
+    CHECK(position - start == Automation::kMaxLength + 1);
+    //The knob is left where it stopped, a step off the lane's values.
+    auto left = sweep(position - 1 - start);
+    float worst = 0;
+    for (uint32_t i = 0; i < Automation::kMaxLength; i++) {
+        auto tick = (position - start) % Automation::kMaxLength;
+        auto v = pass(left);
+        worst = fmaxf(worst, fabsf(v - sweep(tick)));
+    }
+    printf("swept knob over %u ticks, worst error %.4f\n", Automation::kMaxLength, worst);
+    CHECK(worst < 0.01f);
+    return 0;
+}
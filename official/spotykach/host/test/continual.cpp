@@ -0,0 +1,64 @@
+/*
+Continual playback of a 100 Hz sine under knob moves. A slice position
+jump fades over instead of scrubbing through the source, and the pitch
+knob leaving or reaching its centre crossfades out of or into the bypass.
+The largest per-sample step around any of them stays near the steady
+playback's, the shifted one is a little higher in pitch.
+*/
+
+#include <stdio.h>
+#include <math.h>
+#include "check.h"
+#include "rig.h"
+
+using namespace blptls::spotykach;
+
+static constexpr float kW = 2.f * static_cast<float>(M_PI) * 100.f / kSampleRate;
+static constexpr size_t kPeriod = kSampleRate / 100;
+
+static float sine(size_t frame) {
+    return 0.5f * sinf(kW * frame);
+}
+
+static float largest_step(const std::vector<float>& out) {
+    float step = 0;
+    for (size_t n = 1; n < out.size(); n++) step = fmaxf(step, fabsf(out[n] - out[n - 1]));
+    return step;
+}
+
+int main() {
+    static host::Rig rig;
+    auto& engine = rig.core.engineAt(0);
+    //The whole buffer, whole periods, so playback loops without a cut.
+    rig.record(0, kSourceBufferLength, sine);
+    auto length = static_cast<float>(kSourceBufferLength);
+    engine.set_slice_position(10 * kPeriod / length);
+    rig.core.set_playback_controls({ true, false, false, false });
+    //The clock stays stopped, no slices are triggered.
+
+    std::vector<float> steady, jump;
+    rig.render(kSampleRate / 2);
+    rig.render(kSampleRate / 4, &steady);
+    //Two seconds further and a quarter period off, a crest against a crossing.
+    engine.set_slice_position((210 * kPeriod + kPeriod / 4) / length);
+    rig.render(kSampleRate / 4, &jump);
+    auto reference = largest_step(steady);
+    auto jumped = largest_step(jump);
+
+    //Shifted, then back to the centre.
+    std::vector<float> shifted, bypassed;
+    engine.set_pitch_shift(0.55f);
+    rig.render(kSampleRate / 2, &shifted);
+    engine.set_pitch_shift(0.5f);
+    rig.render(kSampleRate / 4, &bypassed);
+    auto leaving = largest_step(shifted);
+    auto centred = largest_step(bypassed);
+
+    printf("largest step: steady %.4f, position jump %.4f, out of the bypass %.4f, into it %.4f\n",
+        reference, jumped, leaving, centred);
+    CHECK(reference > 0);
+    CHECK(jumped < 1.5f * reference);
+    CHECK(leaving < 2.f * reference);
+    CHECK(centred < 1.5f * reference);
+    return 0;
+}
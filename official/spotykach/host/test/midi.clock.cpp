@@ -0,0 +1,127 @@
+/*
+Replays MIDI clock streams with realistic timing noise through
+MidiClock and Clock the way the firmware runs them: bytes arrive in
+DMA chunks, the main loop pulls at uneven intervals and the audio
+callback ticks the clock every block. Checks the tick count, the
+tempo and the transport.
+*/
+
+#include <stdio.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "check.h"
+#include "control/clock.h"
+#include "control/midi.clock.h"
+
+using namespace blptls::spotykach;
+
+struct Ticks: public Clockable {
+    void tick() override { count++; }
+    uint32_t count { 0 };
+};
+
+struct Byte {
+    uint32_t time;
+    uint8_t value;
+};
+
+static constexpr uint32_t kByteMks = 320;
+
+/*
+A sender at the given tempo: clocks jittered by up to jitter_mks,
+one in fifty late by a few ms, and note messages in between.
+*/
+static std::vector<Byte> stream(float bpm, uint32_t clocks, uint32_t jitter_mks, std::mt19937& rng) {
+    std::vector<Byte> bytes;
+    std::uniform_int_distribution<int32_t> jitter(-static_cast<int32_t>(jitter_mks), jitter_mks);
+    std::uniform_int_distribution<int> late(0, 49);
+    auto interval = 60e6 / bpm / 24;
+    uint32_t start = 10000;
+    bytes.push_back({ start, 0xFA });
+    for (uint32_t i = 0; i < clocks; i++) {
+        auto time = static_cast<uint32_t>(start + kByteMks + i * interval + jitter(rng) + (late(rng) == 0 ? 3000 : 0));
+        if (i % 6 == 3) {
+            auto note = static_cast<uint32_t>(start + i * interval + interval / 2);
+            bytes.push_back({ note, 0x90 });
+            bytes.push_back({ note + kByteMks, 60 });
+            bytes.push_back({ note + 2 * kByteMks, 100 });
+        }
+        bytes.push_back({ time, 0xF8 });
+    }
+    std::stable_sort(bytes.begin(), bytes.end(), [](const Byte& a, const Byte& b) { return a.time < b.time; });
+    return bytes;
+}
+
+struct Result {
+    uint32_t ticks;
+    float tempo;
+};
+
+/*
+Runs the stream and then more_mks of silence. The DMA hands over bytes
+in chunks of up to 4, the main loop pulls every 50 to 1000 us.
+*/
+static Result replay(Clock& clock, MidiClock& midi, Ticks& ticks, const std::vector<Byte>& bytes, uint32_t more_mks, std::mt19937& rng) {
+    std::uniform_int_distribution<uint32_t> poll(50, 1000);
+    std::uniform_int_distribution<size_t> chunk(1, 4);
+    auto end = bytes.back().time + more_mks;
+    size_t next = 0;
+    uint32_t next_block = 0;
+    uint32_t next_poll = 0;
+    for (uint32_t now = 0; now < end; now++) {
+        if (next < bytes.size() && bytes[next].time <= now) {
+            auto count = std::min(chunk(rng), bytes.size() - next);
+            //A chunk is handed over once its last byte is in.
+            if (bytes[next + count - 1].time <= now) {
+                uint8_t data[4];
+                for (size_t i = 0; i < count; i++) data[i] = bytes[next + i].value;
+                midi.receive(data, count, now);
+                next += count;
+            }
+        }
+        if (now >= next_poll) {
+            midi.pull(clock);
+            next_poll = now + poll(rng);
+        }
+        if (now >= next_block) {
+            clock.tick();
+            next_block += Policy::block_mks;
+        }
+    }
+    return { ticks.count, clock.tempo() };
+}
+
+int main() {
+    std::mt19937 rng(1234);
+    for (float bpm: { 90.f, 120.f, 174.f }) {
+        Ticks ticks;
+        Clock clock;
+        MidiClock midi;
+        clock.run(ticks);
+        clock.set_tempo(0);
+
+        const uint32_t clocks = 24 * 16;
+        auto result = replay(clock, midi, ticks, stream(bpm, clocks, 500, rng), 0, rng);
+        printf("%.0f bpm: %u ticks for %u clocks, tempo %.2f\n", bpm, result.ticks, clocks, result.tempo);
+        CHECK(clock.is_running());
+        //The first clock starts playback, each later one is 4 ticks.
+        CHECK(result.ticks + 4 >= (clocks - 1) * 4 && result.ticks <= clocks * 4);
+        CHECK(fabsf(result.tempo - bpm) < 0.01f * bpm);
+
+        //Stop halts the ticks, continue picks them up on the next clock.
+        uint8_t stop = 0xFC;
+        midi.receive(&stop, 1, 0);
+        midi.pull(clock);
+        CHECK(!clock.is_running());
+        auto stopped = ticks.count;
+        for (int i = 0; i < 1000; i++) clock.tick();
+        CHECK(ticks.count == stopped);
+
+        uint8_t resume[] { 0xFB, 0xF8, 0xF8 };
+        midi.receive(resume, 3, 0);
+        midi.pull(clock);
+        CHECK(clock.is_running());
+    }
+    return 0;
+}
@@ -0,0 +1,39 @@
+/*
+Mutex: engine B doesn't trigger on the ticks engine A triggers on,
+the first tick after a reset included.
+*/
+
+#include "check.h"
+#include "rig.h"
+
+using namespace blptls::spotykach;
+
+static host::Rig rig;
+static int starts[kEnginesCount];
+
+//Slice starts per engine over the first ticks after a reset.
+static void count(bool mutex) {
+    rig.core.setMutex(mutex);
+    for (uint32_t i = 0; i < kEnginesCount; i++) {
+        rig.core.engineAt(i).reset(false);
+        starts[i] = 0;
+    }
+    rig.play();
+    //Less than a sixteenth, so the only points are those of tick 0.
+    rig.render(kSampleRate / 20);
+    rig.stop();
+}
+
+int main() {
+    rig.record(0, kSampleRate, host::test_loop);
+    rig.record(1, kSampleRate, host::test_loop);
+    rig.core.engineAt(0).set_on_slice([](uint32_t, bool) { starts[0]++; });
+    rig.core.engineAt(1).set_on_slice([](uint32_t, bool) { starts[1]++; });
+
+    count(false);
+    CHECK(starts[0] == 1 && starts[1] == 1);
+
+    count(true);
+    CHECK(starts[0] == 1 && starts[1] == 0);
+    return 0;
+}
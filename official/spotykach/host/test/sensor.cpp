@@ -0,0 +1,88 @@
+/*
+Pad combos: while an exclusive combo is held, the single pads under it
+do nothing, whichever pad of it was touched first.
+*/
+
+#include "check.h"
+#include "control/descrete.sensor.h"
+
+using Target = DescreteSensor::Target;
+using Mode = DescreteSensorPad::Mode;
+
+static DescreteSensor sensor;
+static int pattern_minus, pattern_plus, automation;
+
+static void touch(uint16_t pins) {
+    daisy::Mpr121I2C::touched = pins;
+    sensor.process();
+}
+
+int main() {
+    sensor.initialize();
+    sensor.set_on_touch([] { pattern_minus++; }, Target::PatternMinusA);
+    sensor.set_on_touch([] { pattern_plus++; }, Target::PatternPlusA);
+    sensor.set_mode(Mode::Deferred, Target::PatternMinusA);
+    sensor.set_mode(Mode::Deferred, Target::PatternPlusA);
+    sensor.set_on_touch([] { automation++; }, Target::AutomationRecord);
+    sensor.set_exclusive(Target::AutomationRecord);
+
+    //A single pad steps on the release.
+    touch(_pin(1));
+    CHECK(pattern_plus == 0);
+    touch(0);
+    CHECK(pattern_plus == 1);
+
+    //The combo, in either order and released in either order, steps nothing.
+    touch(_pin(1));
+    touch(_pin(1) | _pin(2));
+    CHECK(automation == 1);
+    touch(_pin(2));
+    touch(0);
+    touch(_pin(2));
+    touch(_pin(1) | _pin(2));
+    touch(_pin(1));
+    touch(0);
+    CHECK(automation == 2);
+    CHECK(pattern_plus == 1 && pattern_minus == 0);
+
+    //A one shot under an exclusive combo is off while it's held.
+    sensor.set_exclusive(Target::UndoA);
+    touch(_pin(3));
+    CHECK(sensor.is_on(Target::OneShotRevA));
+    touch(_pin(2) | _pin(3));
+    CHECK(!sensor.is_on(Target::OneShotRevA));
+    touch(_pin(3));
+    CHECK(!sensor.is_on(Target::OneShotRevA));
+    touch(0);
+    CHECK(pattern_minus == 0);
+
+    //An exclusive toggle flips once per touch, its pads do nothing.
+    sensor.set_mode(Mode::Toggle, Target::SpectralA);
+    sensor.set_exclusive(Target::SpectralA);
+    touch(_pin(1));
+    touch(_pin(1) | _pin(3));
+    CHECK(sensor.is_on(Target::SpectralA) && !sensor.is_on(Target::OneShotRevA));
+    touch(_pin(3));
+    touch(0);
+    CHECK(sensor.is_on(Target::SpectralA) && pattern_plus == 1);
+    touch(_pin(1) | _pin(3));
+    touch(0);
+    CHECK(!sensor.is_on(Target::SpectralA));
+
+    //Reverb is on both pattern plus pads, playing doesn't touch it.
+    sensor.set_mode(Mode::Toggle, Target::Reverb);
+    sensor.set_exclusive(Target::Reverb);
+    touch(_pin(4) | _pin(7));
+    touch(0);
+    CHECK(!sensor.is_on(Target::Reverb));
+    touch(_pin(9));
+    touch(_pin(9) | _pin(1));
+    touch(0);
+    CHECK(sensor.is_on(Target::Reverb) && pattern_plus == 1);
+
+    //Both one shots of a channel record and keep playing, RecordA isn't exclusive.
+    touch(_pin(3) | _pin(4));
+    CHECK(sensor.is_on(Target::RecordA) && sensor.is_on(Target::OneShotFwdA));
+    touch(0);
+    return 0;
+}
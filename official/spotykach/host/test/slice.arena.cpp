@@ -0,0 +1,94 @@
+/*
+Slice arena under random slice lengths: frames handed to a slot are
+never handed out again while it plays, a retained slot gets its own
+frames back, and the longest slice always fits once nothing else plays.
+Prints how often a slice found no room and played from the source.
+*/
+
+#include <stdio.h>
+#include <random>
+#include "check.h"
+#include "slice.arena.h"
+
+using namespace blptls::spotykach;
+
+static SliceArena arena;
+
+struct Slot {
+    size_t begin;
+    size_t frames;
+    bool is_live;
+    bool has_frames;
+};
+
+static Slot slots[kSlicesCount];
+
+//Every slot fills its frames with its own mark, so an overlap shows.
+static void mark(size_t slot) {
+    auto& s = slots[slot];
+    for (size_t f = s.begin; f < s.begin + s.frames; f++) arena.channel(0)[f] = arena.channel(1)[f] = slot + 1.f;
+}
+
+//Every 64th frame and the last, slices are longer than that.
+static bool is_intact(size_t slot) {
+    auto& s = slots[slot];
+    auto is_marked = [slot](size_t f) { return arena.channel(0)[f] == slot + 1.f && arena.channel(1)[f] == slot + 1.f; };
+    for (size_t f = s.begin; f < s.begin + s.frames; f += 64) {
+        if (!is_marked(f)) return false;
+    }
+    return is_marked(s.begin + s.frames - 1);
+}
+
+int main() {
+    arena.initialize();
+    std::mt19937 rng { 41 };
+    std::uniform_int_distribution<size_t> slot_of { 0, kSlicesCount - 1 };
+    std::uniform_int_distribution<size_t> length_of { kSampleRate / 50, kSliceBufferLength };
+    std::uniform_int_distribution<int> action_of { 0, 9 };
+
+    size_t allocations = 0, uncached = 0, retained = 0;
+    for (int i = 0; i < 50000; i++) {
+        auto slot = slot_of(rng);
+        auto& s = slots[slot];
+        auto action = action_of(rng);
+        if (action < 6) {
+            //A slice starts: new frames, or the same ones again after it ended.
+            if (!s.is_live && s.has_frames && action == 0) {
+                if (arena.retain(slot)) {
+                    CHECK(is_intact(slot));
+                    s.is_live = true;
+                    retained++;
+                }
+                continue;
+            }
+            //A slot that still plays is cut for the new slice, as the generator does.
+            auto frames = length_of(rng);
+            auto begin = arena.allocate(slot, frames);
+            allocations++;
+            s.is_live = begin != SliceArena::kNone;
+            s.has_frames = s.is_live;
+            if (!s.is_live) {
+                uncached++;
+                continue;
+            }
+            CHECK(begin + frames <= kSliceArenaLength);
+            s.begin = begin;
+            s.frames = frames;
+            mark(slot);
+        }
+        else if (s.is_live) {
+            CHECK(is_intact(slot));
+            arena.release(slot);
+            s.is_live = false;
+        }
+        for (size_t j = 0; j < kSlicesCount; j++) if (slots[j].is_live) CHECK(is_intact(j));
+    }
+    printf("%zu allocations, %.1f%% uncached, %zu retained\n", allocations, 100.f * uncached / allocations, retained);
+
+    for (size_t j = 0; j < kSlicesCount; j++) arena.release(j);
+    for (size_t j = 0; j < kSlicesCount; j++) {
+        CHECK(arena.allocate(j, kSliceBufferLength) != SliceArena::kNone);
+        arena.release(j);
+    }
+    return 0;
+}
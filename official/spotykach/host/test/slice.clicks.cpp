@@ -0,0 +1,62 @@
+/*
+Click energy of slices cut from a 100 Hz sine. Any sinusoid of that
+frequency satisfies x[n] = 2cos(w)x[n-1] - x[n-2], so the energy of
+what's left over is what the slice envelopes and cuts add.
+Starts on a zero crossing get the short aligned declick, starts
+on a crest the full one. Both have to stay far below a hard cut.
+*/
+
+#include <stdio.h>
+#include "check.h"
+#include "rig.h"
+
+using namespace blptls::spotykach;
+
+static constexpr float kW = 2.f * static_cast<float>(M_PI) * 100.f / kSampleRate;
+static constexpr size_t kPeriod = kSampleRate / 100;
+
+static float sine(size_t frame) {
+    return 0.5f * sinf(kW * frame);
+}
+
+static uint32_t slices { 0 };
+
+//Residual energy per slice.
+static float click_energy(host::Rig& rig, float position) {
+    rig.core.engineAt(0).set_slice_position(position);
+    std::vector<float> out;
+    slices = 0;
+    rig.play();
+    rig.render(4 * kSampleRate, &out);
+    rig.stop();
+    rig.render(kSampleRate, &out);
+    CHECK(slices > 0);
+
+    double energy = 0;
+    auto k = 2.f * cosf(kW);
+    for (size_t n = 2; n < out.size(); n++) {
+        auto r = out[n] - k * out[n - 1] + out[n - 2];
+        energy += r * r;
+    }
+    return energy / slices;
+}
+
+int main() {
+    static host::Rig rig;
+    rig.core.engineAt(0).set_on_slice([](uint32_t, bool) { slices++; });
+    rig.record(0, 4 * kSampleRate, sine);
+
+    //A whole number of periods in is a crossing, a quarter period more a crest.
+    //The positions are further apart than fcomp() tells apart.
+    auto length = static_cast<float>(kSourceBufferLength);
+    auto crossing = click_energy(rig, 125 * kPeriod / length);
+    auto crest = click_energy(rig, (250 * kPeriod + kPeriod / 4) / length);
+
+    //A hard cut at the crest of the output leaves about peak^2 at each end.
+    auto peak = 0.5f * 1.7f;
+    auto hard_cut = 2 * peak * peak;
+    printf("click energy per slice: on a crossing %.2e, on a crest %.2e, hard cut %.2e\n", crossing, crest, hard_cut);
+    CHECK(crossing < 1e-3f * hard_cut);
+    CHECK(crest < 1e-3f * hard_cut);
+    return 0;
+}
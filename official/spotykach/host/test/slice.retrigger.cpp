@@ -0,0 +1,83 @@
+/*
+Retrigger of a playing slice on a 100 Hz sine. The old playback fades
+out under the new one, so the largest per-sample step has to stay near
+the sine's own, with the frames reused and read from the source alike.
+The retrigger comes on a crest, where a cut would step by the amplitude.
+*/
+
+#include <stdio.h>
+#include "check.h"
+#include "slice.h"
+#include "slice.buffer.h"
+#include "envelope.h"
+#include "globals.h"
+
+using namespace blptls::spotykach;
+
+static constexpr float kW = 2.f * static_cast<float>(M_PI) * 100.f / kSampleRate;
+static constexpr size_t kPeriod = kSampleRate / 100;
+
+//The sine for every frame, nothing is recorded.
+class SineSource: public ISource {
+public:
+    void set_frozen(bool) override {}
+    bool is_frozen() override { return true; }
+    void set_antifreeze(bool) override {}
+    size_t length() override { return kSourceBufferLength; }
+    void set_cycle_start(size_t) override {}
+    void initialize() override {}
+    void write(float, float) override {}
+    bool is_idle() override { return true; }
+    size_t read_head() override { return 0; }
+    void read(float& out0, float& out1, size_t frame) override { out0 = out1 = sinf(kW * frame); }
+    size_t nearest_onset(size_t frame, size_t) override { return frame; }
+    SignalLevel level(size_t, size_t) override { return { -1, 1, 0.7f }; }
+    size_t nearest_zero_crossing(size_t frame, size_t) override { return frame; }
+    void reset() override {}
+    void sweep() override {}
+    bool undo() override { return false; }
+    bool redo() override { return false; }
+    bool is_restoring() override { return false; }
+};
+
+static SineSource source;
+static SliceArena arena;
+static SliceBuffer buffer;
+static Envelope envelope;
+
+//Largest step once a slice played for the given frames is retriggered at offset.
+static float largest_step(Slice& slice, size_t played, size_t offset) {
+    const size_t length = kSampleRate / 2;
+    CHECK(played < length);
+    float out0, out1, last = 0, step = 0;
+    slice.prepare(0, length, false, 0.5f, 1.f);
+    slice.start();
+    for (size_t f = 0; f < played; f++) slice.synthesize(&last, &out1);
+    slice.prepare(offset, length, false, 0.5f, 1.f);
+    slice.start();
+    //Up to the new playback's own decay.
+    for (size_t f = 0; f < length; f++) {
+        slice.synthesize(&out0, &out1);
+        if (f < length - kDeclickFrames) step = std::max(step, fabsf(out0 - last));
+        last = out0;
+    }
+    CHECK(slice.isInactive());
+    return step;
+}
+
+int main() {
+    arena.initialize();
+    buffer.attach(arena, 0);
+    static Slice slice { source, buffer, envelope };
+    slice.initialize();
+
+    //A whole number of periods and a quarter in is a crest.
+    auto played = 20 * kPeriod + kPeriod / 4;
+    auto reused = largest_step(slice, played, 0);
+    auto moved = largest_step(slice, played, 7 * kPeriod);
+    auto sine = 2.f * sinf(kW / 2);
+    printf("largest step: reused %.4f, from the source %.4f, plain sine %.4f\n", reused, moved, sine);
+    CHECK(reused < 1.5f * sine);
+    CHECK(moved < 1.5f * sine);
+    return 0;
+}
@@ -0,0 +1,48 @@
+/*
+Slot switches: the crossfade from the previous slot runs with
+the frames, whether the engine is writing or idle.
+*/
+
+#include "check.h"
+#include "source.bank.h"
+
+using namespace blptls::spotykach;
+
+static SourceBank bank;
+
+static void record(float value) {
+    bank.set_frozen(false);
+    for (size_t f = 0; f < 4096; f++) bank.write(value, value);
+    bank.set_frozen(true);
+    while (!bank.is_idle()) bank.write(value, value);
+}
+
+static float read(size_t frame) {
+    float l, r;
+    bank.read(l, r, frame);
+    return l;
+}
+
+int main() {
+    static_assert(kSourceSlots > 1, "A bank needs slots to switch");
+    bank.initialize();
+    record(0.5f);
+    bank.select_slot(1);
+    CHECK(bank.apply_selection());
+    record(-0.5f);
+
+    //Switched by the writing engine, the fade is over once the frames are written.
+    bank.select_slot(0);
+    CHECK(bank.apply_selection());
+    CHECK(read(1000) < 0.f);
+    for (size_t f = 0; f < kSourceSwitchFrames; f++) bank.write(0, 0);
+    CHECK(read(1000) == 0.5f);
+
+    //Switched by an idle engine, the same frames pass in blocks it skips.
+    bank.select_slot(1);
+    CHECK(bank.apply_selection());
+    CHECK(read(1000) > 0.f);
+    for (size_t f = 0; f < kSourceSwitchFrames; f += kBufferSize) bank.skip(kBufferSize);
+    CHECK(read(1000) == -0.5f);
+    return 0;
+}
@@ -0,0 +1,107 @@
+/*
+Lazy source clearing: a reset and every sweep step fit well inside
+an audio block, stale chunks read and measure as silence
+until they are cleared, see Source::reset, and recording over them
+costs about the same in every block, see Source::prepare.
+*/
+
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include "check.h"
+#include "source.h"
+
+using namespace blptls::spotykach;
+
+static Source source;
+
+template <typename F>
+static double microseconds(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double, std::micro> d = std::chrono::steady_clock::now() - start;
+    return d.count();
+}
+
+static void record(size_t frames) {
+    source.set_frozen(false);
+    for (size_t f = 0; f < frames; f++) {
+        auto v = (f * 2654435761u % 2001) / 1000.f - 1.f;
+        source.write(v, -v);
+    }
+    source.set_frozen(true);
+}
+
+/*
+Microseconds of the worst write() block of a take, over stale chunks
+or over the ones the take before left. Every block is timed a few
+times and the best is kept, so a preemption on the host doesn't count.
+*/
+static double worst_block_us(bool stale) {
+    const size_t blocks = 16 * 1024 / kBufferSize;
+    std::vector<double> best(blocks, 1e9);
+    for (int run = 0; run < 5; run++) {
+        if (stale) source.reset();
+        source.set_cycle_start(0);
+        source.set_frozen(false);
+        for (size_t b = 0; b < blocks; b++) {
+            best[b] = std::min(best[b], microseconds([b] {
+                for (size_t f = b * kBufferSize; f < (b + 1) * kBufferSize; f++) {
+                    auto v = (f * 2654435761u % 2001) / 1000.f - 1.f;
+                    source.write(v, -v);
+                }
+            }));
+        }
+        source.set_frozen(true);
+        while (!source.is_idle()) source.write(0, 0);
+    }
+    return *std::max_element(best.begin(), best.end());
+}
+
+static float peak(size_t from, size_t to) {
+    return source.level(from, to).peak();
+}
+
+int main() {
+    source.initialize();
+    record(kSourceBufferLength);
+    CHECK(peak(100, 900) > 0.5f);
+
+    //The best of a few, so a preemption on the host doesn't fail the test.
+    double reset_us = 1e9;
+    for (int i = 0; i < 5; i++) {
+        reset_us = std::min(reset_us, microseconds([] { source.reset(); }));
+        record(kSourceBufferLength);
+    }
+    source.reset();
+
+    //Level 0 cells still hold the take, the partial hops have to ignore them.
+    CHECK(peak(100, 900) == 0);
+    CHECK(peak(kSourceBufferLength - 100, kSourceBufferLength + 100) == 0);
+    CHECK(peak(0, kSourceBufferLength) == 0);
+    float l, r;
+    source.read(l, r, 500);
+    CHECK(l == 0 && r == 0);
+
+    double sweep_us = 0;
+    const size_t steps = kSourceBufferLength / 1024 + 2;
+    for (size_t i = 0; i < steps; i++) sweep_us = std::max(sweep_us, microseconds([] { source.sweep(); }));
+    CHECK(peak(100, 900) == 0);
+
+    record(kSampleRate);
+    CHECK(peak(100, 900) > 0.5f);
+    CHECK(peak(2 * kSampleRate, 3 * kSampleRate) == 0);
+
+    //What recording over stale chunks adds to the worst block, a chunk is
+    //zeroed a few frames at a time, never all of it in one block.
+    auto stale_us = worst_block_us(true);
+    auto overdub_us = worst_block_us(false);
+
+    printf("source reset %.2f us, worst sweep step %.2f us, audio block %u us\n", reset_us, sweep_us, Policy::block_mks);
+    printf("worst write() block: over stale chunks %.2f us, overdub %.2f us\n", stale_us, overdub_us);
+    CHECK(reset_us < Policy::block_mks);
+    CHECK(sweep_us < Policy::block_mks);
+    CHECK(stale_us - overdub_us < 0.05 * Policy::block_mks);
+    return 0;
+}
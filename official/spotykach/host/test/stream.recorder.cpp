@@ -0,0 +1,120 @@
+/*
+The stream recorder against a file that stalls now and then: the ring
+rides out a stall shorter than itself, a longer one drops whole blocks,
+and the WAV header always matches the data written.
+Time is simulated, a write takes as long as the sink says.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include "check.h"
+#include "control/stream.recorder.h"
+#include "core/globals.h"
+
+using namespace blptls::spotykach;
+
+static constexpr uint32_t kWriteMks = 300;
+
+class StallingSink: public RecorderSink {
+public:
+    StallingSink(uint32_t stall_at, uint32_t stall_mks): _stall_at { stall_at }, _stall_mks { stall_mks } {
+        file = tmpfile();
+    }
+
+    bool write(const void* data, uint32_t bytes) override {
+        now_mks += _writes++ == _stall_at ? _stall_mks : kWriteMks;
+        return fwrite(data, 1, bytes, file) == bytes;
+    }
+
+    bool write_header(const void* header, uint32_t bytes) override {
+        auto end = ftell(file);
+        if (end < static_cast<long>(bytes)) end = bytes;
+        return fseek(file, 0, SEEK_SET) == 0 && fwrite(header, 1, bytes, file) == bytes && fseek(file, end, SEEK_SET) == 0;
+    }
+
+    bool sync() override { return fflush(file) == 0; }
+    void close() override { fflush(file); }
+
+    FILE* file;
+    uint64_t now_mks = 0;
+
+private:
+    uint32_t _writes = 0;
+    uint32_t _stall_at;
+    uint32_t _stall_mks;
+};
+
+static float sample(uint64_t frame) {
+    return static_cast<float>(frame % 2000) / 1000.f - 1.f;
+}
+
+static int16_t s16(float v) {
+    return static_cast<int16_t>(v * 32767.f);
+}
+
+//Records seconds of a ramp through the main loop and checks the file.
+static RecorderStats record(uint32_t stall_mks, float seconds) {
+    StallingSink sink { 100, stall_mks };
+    StreamRecorder recorder;
+    recorder.initialize(StreamRecorder::Tap::Output, sink);
+
+    float l[kBufferSize], r[kBufferSize];
+    const float* out[] { l, r };
+    uint64_t fed = 0;
+    auto total = static_cast<uint64_t>(seconds * kSampleRate);
+    while (fed < total) {
+        //The audio callbacks that came while the main loop was busy.
+        while (fed + kBufferSize <= sink.now_mks * kSampleRate / 1000000) {
+            for (size_t f = 0; f < kBufferSize; f++) l[f] = -(r[f] = sample(fed + f));
+            recorder.write(out, out, kBufferSize);
+            fed += kBufferSize;
+        }
+        //A main loop pass runs the job till it's done.
+        auto is_written = false;
+        while (recorder.pull()) is_written = true;
+        if (!is_written) sink.now_mks += 50;
+    }
+    recorder.stop();
+    auto stats = recorder.stats();
+    CHECK(stats.errors == 0);
+
+    uint32_t header[11];
+    fseek(sink.file, 0, SEEK_END);
+    auto size = ftell(sink.file);
+    fseek(sink.file, 0, SEEK_SET);
+    CHECK(fread(header, 4, 11, sink.file) == 11);
+    CHECK(header[10] == stats.written_frames * 4);
+    CHECK(header[1] == header[10] + 36);
+    CHECK(static_cast<uint32_t>(size) == 44 + header[10]);
+    CHECK(stats.written_frames + stats.dropped_frames <= fed);
+    CHECK(fed - stats.written_frames - stats.dropped_frames < 2 * 512);
+
+    //Frames come in order, a dropped block leaves a gap and nothing else.
+    uint64_t frame = 0;
+    int16_t lr[2];
+    for (uint32_t i = 0; i < stats.written_frames; i++) {
+        CHECK(fread(lr, 2, 2, sink.file) == 2);
+        while (lr[1] != s16(sample(frame)) && frame < fed) frame++;
+        CHECK(lr[1] == s16(sample(frame)) && lr[0] == s16(-sample(frame)));
+        frame++;
+    }
+    fclose(sink.file);
+    return stats;
+}
+
+int main() {
+    //A second long stall fits into the ring.
+    auto stats = record(1000000, 4.f);
+    CHECK(stats.overruns == 0 && stats.dropped_frames == 0);
+    printf("1 s stall: worst fill %u frames\n", stats.max_fill);
+    CHECK(stats.max_fill >= kSampleRate);
+
+    //Two seconds don't, what doesn't fit is dropped in whole blocks.
+    stats = record(2000000, 4.f);
+    CHECK(stats.overruns > 0);
+    CHECK(stats.dropped_frames == stats.overruns * kBufferSize);
+    CHECK(stats.dropped_frames == 2 * kSampleRate - stats.max_fill);
+    printf("2 s stall: %u frames dropped in %u blocks, worst fill %u frames\n",
+        stats.dropped_frames, stats.overruns, stats.max_fill);
+    return 0;
+}
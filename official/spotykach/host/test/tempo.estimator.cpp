@@ -0,0 +1,84 @@
+/*
+Tempo estimates of synthetic loops: kick, snare and hats at a few tempos
+and feels. A take without a pulse leaves the clock alone.
+*/
+
+#include <stdio.h>
+#include <math.h>
+#include "check.h"
+#include "rig.h"
+#include "control/tempo.estimator.h"
+
+using namespace blptls::spotykach;
+
+static host::Rig rig;
+static TempoEstimator estimator;
+
+struct Loop {
+    const char* name;
+    float tempo;
+    float swing;     //delay of the off-beat eighths, in eighths
+    bool is_sparse;  //kick on one and three only, no hats
+};
+
+static float hit(float t, float frequency, float decay) {
+    return t >= 0 ? expf(-decay * t) * sinf(2.f * static_cast<float>(M_PI) * frequency * t) : 0.f;
+}
+
+static float noise(size_t frame) {
+    return (frame * 2654435761u % 2001) / 1000.f - 1.f;
+}
+
+static float drums(const Loop& loop, size_t frame) {
+    auto beat = 60.f / loop.tempo;
+    auto t = static_cast<float>(frame) / kSampleRate;
+    auto b = static_cast<size_t>(t / beat);
+    auto in_beat = t - b * beat;
+    float v = 0;
+    if (!loop.is_sparse || b % 2 == 0) v += 0.8f * hit(in_beat, 60.f, 12.f);
+    if (b % 4 == 1 || b % 4 == 3) v += 0.4f * noise(frame) * expf(-20.f * in_beat);
+    if (!loop.is_sparse) {
+        auto off = (0.5f + 0.5f * loop.swing) * beat;
+        v += 0.15f * noise(frame + 7) * expf(-60.f * in_beat);
+        v += 0.15f * noise(frame + 13) * (in_beat >= off ? expf(-60.f * (in_beat - off)) : 0.f);
+    }
+    return v;
+}
+
+static TempoStats estimate(size_t frames, float (*input)(size_t)) {
+    auto estimates = estimator.stats().estimates;
+    auto cancelled = estimator.stats().cancelled;
+    rig.record(0, frames, [input](size_t f) { return input(f); });
+    for (int i = 0; i < 1000 && estimator.stats().estimates == estimates; i++) estimator.pull(rig.core, rig.clock);
+    CHECK(estimator.stats().cancelled == cancelled);
+    return estimator.stats();
+}
+
+static const Loop* current;
+
+int main() {
+    estimator.initialize();
+    const Loop loops[] {
+        { "84 straight",  84,  0,     false },
+        { "96 straight",  96,  0,     false },
+        { "110 swung",    110, 0.33f, false },
+        { "120 straight", 120, 0,     false },
+        { "128 straight", 128, 0,     false },
+        { "140 swung",    140, 0.33f, false },
+        { "160 straight", 160, 0,     false },
+        { "100 sparse",   100, 0,     true  },
+    };
+    for (auto& loop: loops) {
+        current = &loop;
+        auto stats = estimate(8 * kSampleRate, [](size_t f) { return drums(*current, f); });
+        printf("%-14s %6.1f bpm, confidence %.2f, %u us\n", loop.name, stats.tempo, stats.confidence, stats.last_mks);
+        CHECK(fabsf(stats.tempo - loop.tempo) <= 1.f);
+        CHECK(fabsf(rig.clock.tempo() - loop.tempo) <= 1.f);
+    }
+
+    auto before = rig.clock.tempo();
+    auto stats = estimate(8 * kSampleRate, [](size_t f) { return 0.3f * noise(f); });
+    printf("%-14s %6.1f bpm, confidence %.2f\n", "noise", stats.tempo, stats.confidence);
+    CHECK(rig.clock.tempo() == before);
+    return 0;
+}
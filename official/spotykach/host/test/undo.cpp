@@ -0,0 +1,130 @@
+/*
+Stepped undo and redo: each sweep() restores a single chunk, recording
+waits till the take is restored, and the restored chunks index the same
+as if they had been recorded. Saving the chunks for undo doesn't
+stand out of any write() block, see Source::prepare.
+*/
+
+#include <stdio.h>
+#include <chrono>
+#include <math.h>
+#include <vector>
+#include <algorithm>
+#include "check.h"
+#include "rig.h"
+#include "source.h"
+#include "buffers.h"
+
+using namespace blptls::spotykach;
+
+static Source source;
+static Source reference;
+
+static float tone(size_t frame) {
+    return host::test_loop(frame);
+}
+
+static float noise(size_t frame) {
+    return (frame * 2654435761u % 2001) / 1000.f - 1.f;
+}
+
+template <typename Input>
+static void record(Source& s, size_t from, size_t frames, Input&& input) {
+    s.set_cycle_start(from);
+    s.set_frozen(false);
+    for (size_t f = from; f < from + frames; f++) s.write(input(f), input(f));
+    s.set_frozen(true);
+    //Fade out.
+    while (!s.is_idle()) s.write(0, 0);
+}
+
+/*
+Microseconds of the worst write() block of an overdub. Every block is
+timed over a few takes and the best is kept, so a preemption
+on the host doesn't count.
+*/
+static double worst_block_us(Source& s) {
+    const size_t blocks = 16 * 1024 / kBufferSize;
+    std::vector<double> best(blocks, 1e9);
+    for (int take = 0; take < 5; take++) {
+        s.set_cycle_start(0);
+        s.set_frozen(false);
+        for (size_t b = 0; b < blocks; b++) {
+            auto start = std::chrono::steady_clock::now();
+            for (size_t f = b * kBufferSize; f < (b + 1) * kBufferSize; f++) s.write(noise(f), noise(f));
+            std::chrono::duration<double, std::micro> d = std::chrono::steady_clock::now() - start;
+            best[b] = std::min(best[b], d.count());
+        }
+        s.set_frozen(true);
+        while (!s.is_idle()) s.write(0, 0);
+    }
+    return *std::max_element(best.begin(), best.end());
+}
+
+int main() {
+    auto h0 = Buffers::pool().history_buffer();
+    auto h1 = Buffers::pool().history_buffer();
+    //Touched up front, the first write to a page of the host's memory
+    //would cost more than the copy and the target has no such pages.
+    std::fill(h0, h0 + kHistoryPagesCount * kHistoryPageLength, 0.f);
+    std::fill(h1, h1 + kHistoryPagesCount * kHistoryPageLength, 0.f);
+    source.initialize(h0, h1);
+    reference.initialize();
+    //A second of the loop, then half of it overdubbed with noise.
+    auto length = static_cast<size_t>(kSampleRate);
+    record(source, 0, length, tone);
+    record(reference, 0, length, tone);
+    record(source, length / 4, length / 2, noise);
+    CHECK(source.level(length / 2, length / 2 + 1000).peak() > 0.9f);
+
+    CHECK(source.undo());
+    CHECK(source.is_restoring());
+    CHECK(!source.undo() && !source.redo());
+
+    //A take started now waits for the restore.
+    source.set_frozen(false);
+    source.write(1.f, 1.f);
+    CHECK(source.is_frozen());
+
+    size_t steps = 0;
+    double worst_us = 0;
+    while (source.is_restoring()) {
+        auto start = std::chrono::steady_clock::now();
+        source.sweep();
+        std::chrono::duration<double, std::micro> d = std::chrono::steady_clock::now() - start;
+        worst_us = std::max(worst_us, d.count());
+        steps++;
+    }
+    printf("undo of %zu frames in %zu steps, worst step %.1f us\n", length / 2, steps, worst_us);
+    CHECK(steps > 1);
+    CHECK(!source.is_frozen());
+    source.set_frozen(true);
+    while (!source.is_idle()) source.write(0, 0);
+
+    //The overdub is gone.
+    for (size_t f = length / 4; f < 3 * length / 4; f++) {
+        float l, r, rl, rr;
+        source.read(l, r, f);
+        reference.read(rl, rr, f);
+        CHECK(l == rl && r == rr);
+    }
+
+    //Indices of the restored chunks, from the start of the first one.
+    constexpr auto kChunk = PeakPyramid<0>::kHop * PeakPyramid<0>::kFan;
+    for (size_t f = length / 4 / kChunk * kChunk; f < 3 * length / 4; f += 16) {
+        CHECK(fabsf(source.level(f, f + 256).rms - reference.level(f, f + 256).rms) < 1e-4f);
+        CHECK(source.nearest_zero_crossing(f, 200) == reference.nearest_zero_crossing(f, 200));
+    }
+    //The onset of the second beat, in the overdubbed half.
+    auto onset = reference.nearest_onset(kSampleRate / 2, 256);
+    CHECK(onset != SIZE_MAX);
+    CHECK(source.nearest_onset(kSampleRate / 2, 256) == onset);
+
+    //The reference keeps no history, the difference is the saving.
+    //A chunk saved at once, on its first write, took five times as long.
+    auto saving_us = worst_block_us(source);
+    auto plain_us = worst_block_us(reference);
+    printf("worst write() block: saving for undo %.2f us, without undo %.2f us\n", saving_us, plain_us);
+    CHECK(saving_us < 3 * plain_us);
+    return 0;
+}
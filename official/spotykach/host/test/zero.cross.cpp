@@ -0,0 +1,57 @@
+/*
+Source::nearest_zero_crossing against a scan of every frame,
+including the first block and crossings in neighbouring blocks.
+*/
+
+#include <math.h>
+#include "check.h"
+#include "source.h"
+
+using namespace blptls::spotykach;
+
+static Source source;
+
+static float mono(size_t frame) {
+    float l, r;
+    source.read(l, r, frame);
+    return l + r;
+}
+
+static size_t scan(size_t frame, size_t tolerance, size_t length) {
+    size_t best = SIZE_MAX;
+    for (size_t f = 1; f < length; f++) {
+        auto d = f > frame ? f - frame : frame - f;
+        if (d > tolerance) continue;
+        if ((mono(f) >= 0) != (mono(f - 1) >= 0) && (best == SIZE_MAX || d < (best > frame ? best - frame : frame - best))) best = f;
+    }
+    return best;
+}
+
+int main() {
+    source.initialize();
+    source.set_frozen(false);
+    //Sparse crossings at a frequency that doesn't divide the index blocks,
+    //with a negative start so the first block has one.
+    const size_t length = 20000;
+    for (size_t f = 0; f < length; f++) {
+        auto v = sinf(2.f * static_cast<float>(M_PI) * 97.3f * f / kSampleRate - 0.01f);
+        source.write(v, v);
+    }
+    source.set_frozen(true);
+
+    const size_t tolerance = kZeroCrossTolerance;
+    size_t found = 0;
+    for (size_t frame = 0; frame < length - tolerance; frame += 3) {
+        auto expected = scan(frame, tolerance, length);
+        auto actual = source.nearest_zero_crossing(frame, tolerance);
+        CHECK((expected == SIZE_MAX) == (actual == SIZE_MAX));
+        if (actual == SIZE_MAX) continue;
+        auto expected_d = expected > frame ? expected - frame : frame - expected;
+        auto actual_d = actual > frame ? actual - frame : frame - actual;
+        CHECK(expected_d == actual_d);
+        found++;
+    }
+    CHECK(found > 0);
+    CHECK(source.nearest_zero_crossing(0, tolerance) != SIZE_MAX);
+    return 0;
+}
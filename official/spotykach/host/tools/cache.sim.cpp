@@ -0,0 +1,84 @@
+/*
+Replays the SDRAM accesses of a few playing scenarios through the
+Cortex-M7 D-cache model and prints the miss rates per component,
+see core/access.trace.h and core/cache.model.h.
+
+    make tools && build/tools/cache.sim
+*/
+
+#include <stdio.h>
+#include "rig.h"
+#include "cache.model.h"
+
+using namespace blptls::spotykach;
+
+static CacheModel<> cache;
+static bool tracing { false };
+
+void blptls::spotykach::access_trace(AccessComponent component, const void* address, size_t bytes, bool write) {
+    if (tracing) cache.access(component, address, bytes, write);
+}
+
+struct Scenario {
+    const char* name;
+    float slice_length;
+    int pattern_steps;
+    bool reverse;
+    float pitch;
+    bool continual;
+    bool reverb;
+};
+
+static void print(const char* name) {
+    printf("%-22s", name);
+    for (auto c: { AccessComponent::Source, AccessComponent::SliceBuffer, AccessComponent::FxEngine }) {
+        auto& s = cache.stats(c);
+        printf(" %10llu %6.2f%%", static_cast<unsigned long long>(s.accesses), 100.f * s.miss_rate());
+    }
+    printf("\n");
+}
+
+int main() {
+    static host::Rig rig;
+    //Whole takes, so continual playback never runs into stale chunks.
+    rig.record(0, kSourceBufferLength, host::test_loop);
+    rig.record(1, kSourceBufferLength, host::test_loop);
+
+    const Scenario scenarios[] {
+        { "forward slices",     0.5f, 0, false, 0.5f,  false, false },
+        { "reverse slices",     0.5f, 0, true,  0.5f,  false, false },
+        { "short dense slices", 0.1f, 6, false, 0.5f,  false, false },
+        { "pitched slices",     0.5f, 0, false, 0.75f, false, false },
+        { "continual",          0.5f, 0, false, 0.5f,  true,  false },
+        { "pitched continual",  0.5f, 0, false, 0.75f, true,  false },
+        { "slices and reverb",  0.5f, 0, false, 0.5f,  false, true  },
+    };
+
+    printf("%-22s %10s %7s %10s %7s %10s %7s\n", "", "source", "miss", "slices", "miss", "fx", "miss");
+    for (auto& s: scenarios) {
+        for (int e = 0; e < 2; e++) {
+            auto& engine = rig.core.engineAt(e);
+            engine.set_slice_length(s.slice_length);
+            engine.set_reverse(s.reverse);
+            engine.set_pitch_shift(s.pitch);
+            for (int i = 0; i < s.pattern_steps; i++) engine.trig().next_pattern();
+        }
+        rig.core.set_playback_controls({ s.continual, s.continual, s.reverse, s.reverse });
+        rig.core.set_reverb_amount(s.reverb ? 0.3f : 0.f);
+        rig.play();
+        rig.render(kSampleRate);
+
+        cache.reset();
+        tracing = true;
+        rig.render(4 * kSampleRate);
+        tracing = false;
+        print(s.name);
+
+        rig.stop();
+        for (int e = 0; e < 2; e++) {
+            auto& engine = rig.core.engineAt(e);
+            for (int i = 0; i < s.pattern_steps; i++) engine.trig().prev_pattern();
+        }
+    }
+    return 0;
+}
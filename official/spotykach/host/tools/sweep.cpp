@@ -0,0 +1,173 @@
+/*
+Parameter sweep renderer. Records an input into both engines once, then
+renders every combination of jitter amount, retrigger and pattern balance
+and writes RMS, peak, click count and CPU time per run to a CSV.
+
+    build/tools/sweep [-i input.f32] [-o sweep.csv] [-j workers] [-n steps] [-s seconds]
+
+input.f32 is mono 32-bit float at kSampleRate, e.g. sox in.wav -r 48000 -c 1 -t f32 input.f32,
+it's memory mapped. Without it the test loop is used.
+
+Buffers are one static pool per process, see core/buffers.h, so runs are
+processes, not threads: the workers are forked once the input is recorded
+and fork every run from there, sharing the recorded takes copy-on-write.
+They take the next run from a counter in shared memory, so a worker that
+finishes early keeps taking runs until there are none left.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "rig.h"
+
+using namespace blptls::spotykach;
+
+struct Run {
+    float jitter;
+    float retrigger;
+    float balance;
+    float rms;
+    float peak;
+    uint32_t clicks;
+    float cpu_ms;
+    bool done;
+};
+
+//A step of the second difference above this is counted as a click.
+static constexpr float kClickStep = 0.05f;
+
+static const float* input { nullptr };
+static size_t input_frames { 0 };
+
+static float input_at(size_t frame) {
+    return input ? input[frame % input_frames] : host::test_loop(frame);
+}
+
+static double cpu_ms() {
+    timespec t;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t);
+    return t.tv_sec * 1e3 + t.tv_nsec / 1e6;
+}
+
+static void render(host::Rig& rig, Run& run, size_t frames) {
+    for (uint32_t i = 0; i < kEnginesCount; i++) {
+        rig.core.engineAt(i).set_jitter_amount(run.jitter);
+        rig.core.engineAt(i).trig().set_retrigger(run.retrigger);
+    }
+    rig.core.set_pattern_balance(run.balance);
+
+    std::vector<float> out;
+    out.reserve(frames + kBufferSize);
+    auto start = cpu_ms();
+    rig.play();
+    rig.render(frames, &out);
+    run.cpu_ms = cpu_ms() - start;
+
+    double energy = 0;
+    run.peak = 0;
+    run.clicks = 0;
+    for (size_t n = 0; n < out.size(); n++) {
+        energy += out[n] * out[n];
+        run.peak = std::max(run.peak, fabsf(out[n]));
+        if (n >= 2 && fabsf(out[n] - 2 * out[n - 1] + out[n - 2]) > kClickStep) run.clicks++;
+    }
+    run.rms = out.empty() ? 0 : sqrtf(energy / out.size());
+    run.done = true;
+}
+
+static bool map_input(const char* path) {
+    auto fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(float))) {
+        close(fd);
+        return false;
+    }
+    auto data = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return false;
+    input = static_cast<const float*>(data);
+    input_frames = st.st_size / sizeof(float);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    const char* input_path = nullptr;
+    const char* output_path = "sweep.csv";
+    long workers = sysconf(_SC_NPROCESSORS_ONLN);
+    int steps = 5;
+    float seconds = 8;
+    int opt;
+    while ((opt = getopt(argc, argv, "i:o:j:n:s:")) != -1) {
+        switch (opt) {
+            case 'i': input_path = optarg; break;
+            case 'o': output_path = optarg; break;
+            case 'j': workers = atol(optarg); break;
+            case 'n': steps = atoi(optarg); break;
+            case 's': seconds = atof(optarg); break;
+            default:
+                fprintf(stderr, "usage: %s [-i input.f32] [-o sweep.csv] [-j workers] [-n steps] [-s seconds]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (input_path && !map_input(input_path)) {
+        fprintf(stderr, "can't map %s\n", input_path);
+        return 1;
+    }
+    steps = std::max(steps, 2);
+    workers = std::max(workers, 1l);
+
+    const size_t count = static_cast<size_t>(steps) * steps * steps;
+    auto shared = mmap(nullptr, sizeof(std::atomic<size_t>) + count * sizeof(Run), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED) return 1;
+    auto next = new (shared) std::atomic<size_t> { 0 };
+    auto runs = reinterpret_cast<Run*>(next + 1);
+    for (size_t i = 0; i < count; i++) {
+        auto value = [steps](size_t step) { return static_cast<float>(step) / (steps - 1); };
+        runs[i] = { value(i / (steps * steps)), value(i / steps % steps), value(i % steps), 0, 0, 0, 0, false };
+    }
+
+    static host::Rig rig;
+    auto take = std::min(input ? input_frames : kSourceBufferLength, kSourceBufferLength);
+    rig.record(0, take, input_at);
+    rig.record(1, take, input_at);
+    auto frames = static_cast<size_t>(seconds * kSampleRate);
+
+    for (long w = 0; w < workers; w++) {
+        if (fork() != 0) continue;
+        size_t i;
+        while ((i = next->fetch_add(1)) < count) {
+            auto pid = fork();
+            if (pid == 0) {
+                render(rig, runs[i], frames);
+                _exit(0);
+            }
+            waitpid(pid, nullptr, 0);
+        }
+        _exit(0);
+    }
+    while (wait(nullptr) > 0) {}
+
+    auto csv = fopen(output_path, "w");
+    if (!csv) {
+        fprintf(stderr, "can't write %s\n", output_path);
+        return 1;
+    }
+    fprintf(csv, "jitter,retrigger,balance,rms,peak,clicks,cpu_ms\n");
+    size_t failed = 0;
+    for (size_t i = 0; i < count; i++) {
+        auto& r = runs[i];
+        if (!r.done) failed++;
+        fprintf(csv, "%.3f,%.3f,%.3f,%.5f,%.5f,%u,%.2f\n", r.jitter, r.retrigger, r.balance, r.rms, r.peak, r.clicks, r.cpu_ms);
+    }
+    fclose(csv);
+    printf("%zu runs of %.1f s with %ld workers, %zu failed, see %s\n", count, seconds, workers, failed, output_path);
+    return failed > 0 ? 1 : 0;
+}
@@ -3,6 +3,10 @@
 #include "core/core.h"
 #include "control/controller.h"
 #include "control/clock.h"
+#include "control/midi.clock.h"
+#include "control/stream.recorder.h"
+#include "control/tempo.estimator.h"
+#include "control/scheduler.h"
 #include "control/leds.h"
 #include "common/deb.h"
 #include "control/clock.h"
@@ -16,9 +20,34 @@ Controller controller;
 Core core;
 PlaybackParameters p;
 Clock clck;
+MidiClock midi;
+#if SPOTYKACH_STREAM_RECORDER
+StreamRecorder recorder;
+#endif
+TempoEstimator tempo_estimator;
+Scheduler scheduler;
 Leds leds;
 
+// Milliseconds from hw.Init(), where SysTick starts, to the first audio callback,
+// read it with the debugger. The startup code and hw.Configure() before it don't count.
+volatile uint32_t init_to_audio_ms { 0 };
+// Audio callback load, average and peak, read it with the debugger.
+CpuLoadMeter cpu_load;
+
+constexpr SaiHandle::Config::SampleRate sai_sample_rate(uint32_t sr) {
+	using SR = SaiHandle::Config::SampleRate;
+	switch (sr) {
+		case 8000: return SR::SAI_8KHZ;
+		case 16000: return SR::SAI_16KHZ;
+		case 32000: return SR::SAI_32KHZ;
+		case 96000: return SR::SAI_96KHZ;
+		default: return SR::SAI_48KHZ;
+	}
+}
+
 void AudioCallback(AudioHandle::InputBuffer in, AudioHandle::OutputBuffer out, size_t size) {
+	if (!init_to_audio_ms) init_to_audio_ms = System::GetNow();
+	cpu_load.OnBlockStart();
 	static int cnfg_cnt { 0 };
 	if (++cnfg_cnt == 40) {
 		p.tempo = clck.tempo();
@@ -28,6 +57,10 @@ void AudioCallback(AudioHandle::InputBuffer in, AudioHandle::OutputBuffer out, s
 	clck.tick();
 	core.preprocess(p);
 	core.process(in, out, size);
+#if SPOTYKACH_STREAM_RECORDER
+	recorder.write(in, out, size);
+#endif
+	cpu_load.OnBlockEnd();
 }
 
 int main(void) {
@@ -40,23 +73,30 @@ int main(void) {
 	core.initialize();
 	clck.run(core);
 	controller.initialize(hw, core, clck);
+	midi.initialize();
+	tempo_estimator.initialize();
+#if SPOTYKACH_STREAM_RECORDER
+	recorder.initialize(StreamRecorder::Tap::Output);
+#endif
 
 	leds.initialize();
 	core.engineAt(0).set_on_slice([](uint32_t sl, bool rev){ leds.blink_a(sl, rev); });
 	core.engineAt(1).set_on_slice([](uint32_t sl, bool rev){ leds.blink_b(sl, rev); });
 
 	hw.SetAudioBlockSize(kBufferSize);
-	hw.SetAudioSampleRate(SaiHandle::Config::SampleRate::SAI_48KHZ);
+	hw.SetAudioSampleRate(sai_sample_rate(kSampleRate));
+	cpu_load.Init(hw.AudioSampleRate(), hw.AudioBlockSize());
 	hw.StartAudio(AudioCallback);
 
-	uint32_t count_limit = 10e2;
-	while(1) {
-		clck.pull(hw);
-		leds.tick();
-		static uint32_t counter = 0;
-		if (++counter == count_limit ) {
-			counter = 0;
-			controller.set_parameters(core, leds, clck);
-		}
-	}
+	//Clock input and LED PWM run between all other tasks, see Scheduler.
+	scheduler.add_polled("clock", [] { clck.pull(hw); });
+	scheduler.add_polled("midi", [] { midi.pull(clck); });
+	scheduler.add_polled("leds", [] { leds.tick(); });
+	scheduler.add_periodic("controls", [] { controller.set_parameters(core, leds, clck); }, 2000, 1000);
+#if SPOTYKACH_STREAM_RECORDER
+	scheduler.add_background("recorder", [] { return recorder.pull(); }, 1000);
+#endif
+	scheduler.add_background("sweep", [] { return core.idle(); }, 200);
+	scheduler.add_background("tempo", [] { tempo_estimator.pull(core, clck); return tempo_estimator.is_busy(); }, 500);
+	scheduler.run();
 }